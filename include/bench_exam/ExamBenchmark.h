@@ -0,0 +1,33 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * End-to-end benchmark of the exam. Launches the dean with a fixed seed, seat
+ * count and seat policy, waits for the exam to complete and summarises the
+ * published timeline.
+ */
+class ExamBenchmark {
+public:
+  ExamBenchmark(int placeCount, unsigned int seed, int seatCount,
+                const std::string &seatPolicy = "");
+
+  std::string run();
+
+private:
+  void launchDean();
+  void readTimeline(const char *path);
+  std::string phaseJson(const std::string &name,
+                        const std::vector<double> &values);
+
+  int placeCount_;
+  unsigned int seed_;
+  int seatCount_;
+  std::string seatPolicy_;
+  double wallSeconds_ = 0.0;
+  std::map<std::string, double> examTimings_;
+  std::vector<std::string> columns_;
+  std::vector<std::vector<double>> rows_;
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <pthread.h>
+#include <semaphore.h>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+/**
+ * State shared by all benchmark workers (threads or processes).
+ */
+struct BenchmarkShared {
+  std::atomic<int> ready;
+  std::atomic<bool> go;
+
+  /* Lock primitives */
+  pthread_mutex_t mutex;
+  std::atomic<int> futex;
+  std::atomic_flag spin;
+  sem_t unnamedSemaphore;
+  sem_t *namedSemaphore;
+  long counter;
+
+  /* Shared memory primitives */
+  key_t shmKey;
+  int shmId;
+  size_t shmSize;
+  char shmName[64];
+  char semaphoreName[64];
+};
+
+/**
+ * Benchmarked operation.
+ */
+struct BenchmarkCase {
+  const char *name;
+  /* Fraction of the iterations used by this case (syscall-heavy cases) */
+  int iterationDivisor;
+  void (*setup)(BenchmarkShared *shared);
+  void (*operation)(BenchmarkShared *shared);
+  void (*teardown)(BenchmarkShared *shared);
+};
+
+/**
+ * Result of a single benchmark run.
+ */
+struct BenchmarkResult {
+  std::string name;
+  std::string mode;
+  int workers;
+  int iterations;
+  double wallSeconds;
+  double nsPerOp;
+  double opsPerSecond;
+  double p50;
+  double p90;
+  double p99;
+  double p999;
+  double max;
+};
+
+/**
+ * Micro-benchmark of the IPC primitives used by the simulation and of their
+ * alternatives, run under 1..N contending threads and processes.
+ */
+class IpcBenchmark {
+public:
+  IpcBenchmark(int maxWorkers, int iterations, const std::string &filter,
+               bool processes, bool threads);
+  ~IpcBenchmark();
+
+  std::string run();
+
+private:
+  BenchmarkResult runCase(const BenchmarkCase &benchmarkCase, int workers,
+                          bool processes);
+  static void runWorker(const BenchmarkCase &benchmarkCase,
+                        BenchmarkShared *shared, int iterations,
+                        uint64_t *latencies);
+  static void *threadFunction(void *arg);
+  static double timerOverhead();
+  static std::string toJson(const BenchmarkResult &result);
+
+  int maxWorkers_;
+  int iterations_;
+  std::string filter_;
+  bool processes_;
+  bool threads_;
+  BenchmarkShared *shared_ = nullptr;
+};
@@ -1,8 +1,10 @@
 #pragma once
 
-#include "common/ipc/SemaphoreManager.h"
+#include "common/ipc/LatencyHistogram.h"
+#include "common/ipc/Timeline.h"
 #include "common/process/BaseProcess.h"
 #include <unistd.h>
+#include <vector>
 
 class CandidateProcess : public BaseProcess {
 public:
@@ -15,24 +17,37 @@ public:
   void handleError(const char *message) override;
 
   void waitForExamStart();
-  void waitForQuestions(char commission);
-  void prepareAnswers(char commission);
+  void answerQuestions(char commission);
   void waitForGrading(char commission);
   void maybeExitExam();
   void getCommissionSeat(char commission);
   bool isRetaking();
 
 private:
-  static void rejectionHandler(int signal);
   static void terminationHandler(int signal);
+  void waitForQuestions(char commission);
+  void prepareAnswers(char commission);
+  void answerPipelined(char commission);
+  int chooseShard(char commission);
+  void joinShard(char commission);
+  bool moveShard(char commission);
   int findCommissionSeat(char commission);
+  PhaseTimeline &timeline(char commission);
+  void recordLatency(char commission, LatencyPhase phase, uint64_t from,
+                     uint64_t to);
+  static std::vector<double> parseTimes(const char *list, const char *name);
+
+  /* Interval of looking for a shorter queue while waiting for a seat */
+  static const int rebalanceIntervalMs = 500;
+  /* Interval of checking for new questions while answering pipelined */
+  static const int questionPollMs = 100;
 
   int index;
   int seat = -1;
+  /* Shard of the commission the candidate is queued for or seated at */
+  int shard = 0;
 
-  sem_t *semaphoreA = nullptr;
-  sem_t *semaphoreB = nullptr;
-
-  double timesA[5];
-  double timesB[3];
+  /* Answer time for the question of each member */
+  std::vector<double> timesA;
+  std::vector<double> timesB;
 };
@@ -1,18 +1,24 @@
 #pragma once
 
-#include "common/ipc/SemaphoreManager.h"
+#include "common/ipc/CommissionTraits.h"
 #include "common/ipc/SharedState.h"
 #include "common/process/BaseProcess.h"
 #include <atomic>
+#include <vector>
 
 struct ThreadData {
   int memberId;
   char commissionId;
+  int shard;
   std::atomic<bool> *running;
   pthread_mutex_t *mutex;
 };
 
-class CommissionProcess : public BaseProcess {
+/**
+ * Commission process, instantiated for CommissionA and CommissionB. Each
+ * process serves one shard of its commission type.
+ */
+template <typename Traits> class CommissionProcess : public BaseProcess {
 public:
   CommissionProcess(int argc, char *argv[]);
 
@@ -26,22 +32,26 @@ public:
   void start();
   static void terminationHandler(int signal);
 
-  int memberCount_;
-
 private:
   void mainLoop();
   void spawnThreads();
   void waitThreads();
   static void *threadFunction(void *arg);
-  CommissionInfo *commission();
-  int totalCandidates();
-  bool maybeGradeCandidate(int seat);
+  int gradeAnsweredSeats();
+  bool allGraded();
   void maybeFinish();
+  void maybeRetire();
+  void leave();
+
+  /* Longest wait of an idle member for a question task */
+  static const int idleWaitMs = 1000;
 
-  char commissionType_;
   std::atomic<bool> running = true;
-  sem_t *semaphore;
-  pthread_t threadIds[5];
-  ThreadData threadData[5];
-  std::atomic<int> candidatesProcessed = 0;
+  /* Sized by the member count chosen by the dean */
+  std::vector<pthread_t> threadIds;
+  std::vector<ThreadData> threadData;
+  int shard_ = 0;
 };
+
+extern template class CommissionProcess<CommissionA>;
+extern template class CommissionProcess<CommissionB>;
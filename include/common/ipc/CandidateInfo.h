@@ -1,5 +1,9 @@
 #pragma once
 
+#include "SequenceCounter.h"
+#include "Timeline.h"
+#include <semaphore.h>
+
 /**
  * Candidate status.
  */
@@ -11,6 +15,18 @@ enum CandidateStatus {
   PendingCommissionB = 4,
   Passed = 5,
   Terminated = 6,
+  CandidateStatusCount = 7,
+};
+
+/**
+ * Scores and status of a candidate, copied consistently out of the shared
+ * memory by Memory::readScores().
+ */
+struct CandidateScores {
+  double theoreticalScore;
+  double practicalScore;
+  double finalScore;
+  CandidateStatus status;
 };
 
 /**
@@ -19,8 +35,24 @@ enum CandidateStatus {
 struct CandidateInfo {
   int index = -1;
   int pid;
+  /* Scores and status, written under candidateMutex inside a write section
+   * of scoreSequence and read without a lock */
+  SequenceCounter scoreSequence;
   double theoreticalScore = -1.0; // -1.0 if not graded
   double practicalScore = -1.0;   // -1.0 if not graded
   double finalScore = -1.0;       // -1.0 if not graded
   CandidateStatus status = Pending;
+  bool exited = false; // the process has unregistered itself
+  CandidateTimeline timeline;
+  /* Skips commission A, having passed the theoretical part before */
+  bool retaking = false;
+  /* Sum of the answer times at commission A and B, used by the shortest
+   * job first seat policy */
+  double expectedService[2] = {0.0, 0.0};
+  /* Links of the ticket queue of the shard the candidate waits for */
+  int queuePrev = -1;
+  int queueNext = -1;
+  /* Seat handed over by the commission, posted to seatReady */
+  int assignedSeat = -1;
+  sem_t seatReady;
 };
@@ -1,5 +1,33 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <pthread.h>
+
+/* Upper bound of the shards of each commission type */
+const int maxCommissionShards = 8;
+/* Upper bound of the members of a commission, stored as bits of a mask */
+const int maxCommissionMembers = 30;
+
+/**
+ * How candidates are assigned to the shards of a commission type.
+ */
+enum ShardAssignment {
+  LeastLoadedAssignment = 0, // shard with the fewest queued and seated
+  IndexHashAssignment = 1,   // candidate index modulo the shard count
+};
+
+/**
+ * Seat, member and shard count of a commission type. Shards above shardCount
+ * and up to maxShardCount are spawned by the autoscaler on demand.
+ */
+struct CommissionSize {
+  int seatCount;
+  int memberCount;
+  int shardCount;
+  int maxShardCount;
+};
+
 /**
  * Commission seat.
  */
@@ -10,8 +38,57 @@ struct CommissionSeat {
 };
 
 /**
- * Commission information.
+ * Question a member has to ask the candidate on a seat, one per seat and
+ * member. Queued when the seat is taken.
+ */
+struct QuestionTask {
+  int next = -1; // next seat in the member's queue, -1 if last
+  bool queued = false;
+};
+
+/**
+ * Commission information, one per shard. The seats and the question tasks
+ * live in the variable-size tail of SharedState, after the candidates, and
+ * are sized by the dean at start-up.
  */
 struct CommissionInfo {
-  CommissionSeat seats[3];
-};
\ No newline at end of file
+  int seatCount = 0;
+  int memberCount = 0;
+  /* Questions mask of a seat once every member has asked a question */
+  int fullMask = 0;
+  /* Offset of the first seat from this structure, valid in every mapping */
+  size_t seatsOffset = 0;
+  /* Candidates queued for or seated at this shard */
+  std::atomic<int> load;
+  /* Whether the shard has a running process that takes new candidates;
+   * changed with the shard mutex held */
+  std::atomic<bool> active;
+  /* Set by the autoscaler, the shard exits once its load drains */
+  std::atomic<bool> retiring;
+
+  /* Ticket queue of the candidates waiting for a seat, oldest first;
+   * indices into SharedState::candidates, -1 when empty */
+  int queueHead;
+  int queueTail;
+
+  /* Question tasks, one FIFO queue of seats per member; the members block on
+   * tasksReady with the shard mutex */
+  size_t tasksOffset = 0;
+  int taskHead[maxCommissionMembers];
+  int taskTail[maxCommissionMembers];
+  pthread_cond_t tasksReady;
+
+  /* Whether new candidates may queue for the shard */
+  bool open() const { return active && !retiring; }
+
+  QuestionTask &task(int seat, int member) {
+    return reinterpret_cast<QuestionTask *>(reinterpret_cast<char *>(this) +
+                                            tasksOffset)[seat * memberCount +
+                                                         member];
+  }
+
+  CommissionSeat &seat(int index) {
+    return reinterpret_cast<CommissionSeat *>(reinterpret_cast<char *>(this) +
+                                              seatsOffset)[index];
+  }
+};
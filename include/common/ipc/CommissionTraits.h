@@ -0,0 +1,90 @@
+#pragma once
+
+#include "common/ipc/SharedState.h"
+#include <atomic>
+#include <pthread.h>
+
+/**
+ * Compile-time description of commission A (theoretical part). The
+ * commission process is instantiated for each commission kind, so that its
+ * hot paths do not branch on the commission type.
+ */
+struct CommissionA {
+  static constexpr char type = 'A';
+  /* Index of the commission in the per-commission arrays of SharedState */
+  static constexpr int index = 0;
+  /* Used unless the dean is given other sizes (-s, -a, -b, -n) */
+  static constexpr int defaultSeatCount = 3;
+  static constexpr int defaultMemberCount = 5;
+  static constexpr int defaultShardCount = 1;
+  static constexpr double passingScore = 30.0;
+  /* Whether the exam ends when this commission finishes */
+  static constexpr bool endsExam = false;
+
+  static CommissionInfo &info(SharedState *state, int shard) {
+    return state->commissionA[shard];
+  }
+  static pthread_mutex_t *mutex(SharedState *state, int shard) {
+    return &state->commissionAMutex[shard];
+  }
+  static int shardCount(SharedState *state) {
+    return state->commissionAShardCount;
+  }
+  static std::atomic<int> &candidateCount(SharedState *state) {
+    return state->commissionACandidateCount.value;
+  }
+  static std::atomic<int> &gradedCount(SharedState *state) {
+    return state->commissionAGradedCount.value;
+  }
+  static std::atomic<int> &processedCount(SharedState *state, int shard) {
+    return state->commissionAProcessed[shard].value;
+  }
+  static int &activeShards(SharedState *state) {
+    return state->commissionAActiveShards;
+  }
+  static double &score(CandidateInfo *candidate) {
+    return candidate->theoreticalScore;
+  }
+  static CandidateStatus gradedStatus(double score) {
+    return score < passingScore ? Failed : PendingCommissionB;
+  }
+};
+
+/**
+ * Compile-time description of commission B (practical part), the last
+ * commission of the exam.
+ */
+struct CommissionB {
+  static constexpr char type = 'B';
+  static constexpr int index = 1;
+  static constexpr int defaultSeatCount = 3;
+  static constexpr int defaultMemberCount = 3;
+  static constexpr int defaultShardCount = 1;
+  static constexpr bool endsExam = true;
+
+  static CommissionInfo &info(SharedState *state, int shard) {
+    return state->commissionB[shard];
+  }
+  static pthread_mutex_t *mutex(SharedState *state, int shard) {
+    return &state->commissionBMutex[shard];
+  }
+  static int shardCount(SharedState *state) {
+    return state->commissionBShardCount;
+  }
+  static std::atomic<int> &candidateCount(SharedState *state) {
+    return state->commissionBCandidateCount.value;
+  }
+  static std::atomic<int> &gradedCount(SharedState *state) {
+    return state->commissionBGradedCount.value;
+  }
+  static std::atomic<int> &processedCount(SharedState *state, int shard) {
+    return state->commissionBProcessed[shard].value;
+  }
+  static int &activeShards(SharedState *state) {
+    return state->commissionBActiveShards;
+  }
+  static double &score(CandidateInfo *candidate) {
+    return candidate->practicalScore;
+  }
+  static CandidateStatus gradedStatus(double) { return Passed; }
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Candidate phase measured by the latency histograms.
+ */
+enum LatencyPhase {
+  SeatWaitPhase = 0,
+  QuestionWaitPhase = 1,
+  AnsweringPhase = 2,
+  GradingWaitPhase = 3,
+  LatencyPhaseCount = 4,
+};
+
+/**
+ * Lock-free log-linear (HDR-style) histogram of latencies in microseconds,
+ * placed in shared memory and recorded concurrently by many processes.
+ *
+ * Values below 64 us have their own buckets, larger values are split into 32
+ * sub-buckets per power of two (relative error below 3.2%).
+ */
+struct LatencyHistogram {
+  static const int subBucketBits = 5;
+  static const int subBucketCount = 1 << subBucketBits;
+  static const int linearBucketCount = 2 * subBucketCount;
+  static const int levelCount = 36;
+  static const int bucketCount = linearBucketCount + levelCount * subBucketCount;
+
+  std::atomic<uint64_t> count;
+  std::atomic<uint64_t> sum;
+  std::atomic<uint64_t> max;
+  std::atomic<uint64_t> buckets[bucketCount];
+
+  void record(uint64_t micros);
+  uint64_t percentile(double percent) const;
+  double mean() const;
+
+  static int bucketIndex(uint64_t micros);
+  static uint64_t bucketValue(int index);
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "CandidateInfo.h"
+#include <atomic>
+
+/**
+ * Live counters of a commission.
+ */
+struct CommissionMetrics {
+  std::atomic<int> queued;    // candidates waiting for a seat
+  std::atomic<int> seatsBusy; // occupied seats
+  std::atomic<int> graded;    // candidates graded so far
+};
+
+/**
+ * Live counters of the exam, updated lock-free by all processes and read by
+ * examtop without taking any of the simulation's mutexes.
+ */
+struct LiveMetrics {
+  std::atomic<int> statusCounts[CandidateStatusCount];
+  std::atomic<int> spawned; // child processes spawned by the dean
+  std::atomic<int> reaped;  // child processes reaped by the dean
+  CommissionMetrics commissions[2]; // 0 - commission A, 1 - commission B
+};
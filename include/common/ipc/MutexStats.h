@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Process-shared mutex stored in the shared memory.
+ */
+enum SharedMutex {
+  CandidateMutex = 0,
+  CommissionAMutex = 1,
+  CommissionBMutex = 2,
+  ExamStateMutex = 3,
+  SharedMutexCount = 4,
+};
+
+/**
+ * Contention counters of a shared mutex, recorded by MutexWrapper when built
+ * with MUTEX_PROFILING. All fields are written only by the holder of the
+ * mutex, so they need no synchronization of their own.
+ */
+struct MutexStats {
+  uint64_t acquisitions = 0;
+  uint64_t contended = 0;
+  uint64_t waitNs = 0;
+  uint64_t maxWaitNs = 0;
+  uint64_t holdNs = 0;
+  uint64_t maxHoldNs = 0;
+  uint64_t lockedAt = 0; // monotonic ns of the current acquisition
+};
@@ -1,9 +1,17 @@
 #pragma once
 
+#include "common/ipc/MutexStats.h"
 #include <pthread.h>
 
 class MutexWrapper {
 public:
   static void lock(pthread_mutex_t *mutex);
   static void unlock(pthread_mutex_t *mutex);
+  static bool wait(pthread_cond_t *cond, pthread_mutex_t *mutex,
+                   int timeoutMs = -1);
+
+  static const char *name(SharedMutex mutex);
+
+private:
+  static MutexStats *statsFor(pthread_mutex_t *mutex);
 };
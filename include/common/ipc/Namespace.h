@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+
+/**
+ * Run namespace of an exam instance, taken from the EXAM_NAMESPACE
+ * environment variable and inherited by the children of the dean. The names
+ * of the shared memory and semaphores, as well as the output directory, are
+ * derived from it, so that independent exams can run on the same host.
+ */
+class Namespace {
+public:
+  static const std::string &name();
+  static std::string ipcName(const std::string &object);
+  static std::string outputDirectory();
+  static std::string outputPath(const std::string &file);
+
+private:
+  static std::string readName();
+};
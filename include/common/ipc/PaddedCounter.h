@@ -0,0 +1,21 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+/* Size of a cache line on the supported targets */
+const size_t cacheLineSize = 64;
+
+/**
+ * Counter in shared memory updated lock-free by several processes. Each
+ * counter occupies its own cache line, so that updates of one counter do not
+ * invalidate the line of its neighbours (false sharing).
+ */
+struct alignas(cacheLineSize) PaddedCounter {
+  std::atomic<int> value;
+};
+
+static_assert(sizeof(PaddedCounter) == cacheLineSize,
+              "PaddedCounter must fill exactly one cache line");
+static_assert(std::atomic<int>::is_always_lock_free,
+              "PaddedCounter must be lock-free to be shared between processes");
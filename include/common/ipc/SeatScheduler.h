@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+
+/**
+ * Order in which the waiting candidates of a shard receive the freed seats.
+ */
+enum SeatPolicy {
+  FifoSeatPolicy = 0,          // in arrival order
+  ShortestJobSeatPolicy = 1,   // shortest expected answering time first
+  RetakersFirstSeatPolicy = 2, // retakers first, then in arrival order
+  RandomSeatPolicy = 3,        // uniformly among the waiting candidates
+  SeatPolicyCount = 4,
+};
+
+/**
+ * Selects the candidate that receives a freed seat from the ticket queue of a
+ * shard, according to the policy chosen by the dean.
+ */
+class SeatScheduler {
+public:
+  static SeatPolicy parse(const std::string &name);
+  static const char *name(SeatPolicy policy);
+  static int select(char commission, int shard);
+};
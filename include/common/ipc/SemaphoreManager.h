@@ -11,5 +11,6 @@ public:
   static void close(sem_t *sem);
   static void unlink(const std::string &name);
   static void wait(sem_t *sem);
+  static bool timedWait(sem_t *sem, int timeoutMs);
   static void post(sem_t *sem);
 };
\ No newline at end of file
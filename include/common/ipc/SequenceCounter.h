@@ -0,0 +1,25 @@
+#pragma once
+
+#include <atomic>
+
+/**
+ * Sequence counter of a seqlock, placed in shared memory next to the fields
+ * it protects. Writers, serialized among themselves by a mutex, make the
+ * counter odd for the duration of an update; readers take no lock and retry
+ * when the counter was odd or changed while they were copying the fields.
+ *
+ * Copies carry the counter value, so that structures holding it can still be
+ * copied out of the shared memory.
+ */
+struct SequenceCounter {
+  std::atomic<unsigned> sequence;
+
+  SequenceCounter();
+  SequenceCounter(const SequenceCounter &other);
+  SequenceCounter &operator=(const SequenceCounter &other);
+
+  void beginWrite();
+  void endWrite();
+  unsigned beginRead() const;
+  bool retryRead(unsigned start) const;
+};
@@ -1,8 +1,17 @@
 #pragma once
 
 #include "common/ipc/SharedState.h"
-#include <sys/ipc.h>
-#include <sys/shm.h>
+#include <cstddef>
+#include <string>
+
+/**
+ * Options of the shared memory mapping, see SharedMemoryManager::options().
+ */
+enum SharedMemoryOption {
+  HugePagesOption = 1 << 0,
+  PrefaultOption = 1 << 1,
+  LockOption = 1 << 2,
+};
 
 class SharedMemoryManager {
 public:
@@ -10,16 +19,37 @@ public:
   ~SharedMemoryManager();
 
   static SharedMemoryManager &shared();
-  static void initialize(int count);
+  static void initialize(int count, int seatCount, int taskCount);
   static void destroy();
-  static void attach();
+  static void attach(bool readOnly = false);
   static void detach();
   static SharedState* data();
+  static std::string mode();
+  static int options();
 
 private:
-  static key_t getKey();
-  static size_t getSize(int count);
+  static std::string getName();
+  static std::string getHugePagePath();
+  static size_t getSize(int count, int seatCount, int taskCount);
+  static bool createHugePages(size_t size);
+  static bool transparentHugePagesAvailable();
+  static int mapFlags();
+  static void lock();
+  static long minorFaults();
+  static SharedState *map(int fd, size_t size, bool readOnly);
+  static void recordPrefault();
+
+  static const char *hugePageDirectory;
+  static const size_t hugePageSize = 2 * 1024 * 1024;
 
-  int shmId_ = -1;
+  bool owner_ = false;
+  bool hugetlbfs_ = false;
+  bool transparentHuge_ = false;
+  bool locked_ = false;
+  /* Attached read-only by an observer, which must not log */
+  bool quiet_ = false;
+  /* Page faults taken up front by the prefault option when mapping */
+  long prefaultFaults_ = 0;
+  size_t size_ = 0;
   SharedState* data_ = nullptr;
 };
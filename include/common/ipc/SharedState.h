@@ -2,6 +2,12 @@
 
 #include "CandidateInfo.h"
 #include "CommissionInfo.h"
+#include "LatencyHistogram.h"
+#include "LiveMetrics.h"
+#include "MutexStats.h"
+#include "PaddedCounter.h"
+#include "SeatScheduler.h"
+#include "Timeline.h"
 #include <pthread.h>
 #include <unistd.h>
 
@@ -11,30 +17,79 @@
 struct SharedState {
   /* Exam state */
   bool examStarted = false;
+  /* Participants attached to the shared memory (readiness barrier) */
+  int readyCount = 0;
   int candidateCount;
-  int commissionACandidateCount;
-  int commissionBCandidateCount;
+  /* Shards running, over all shards of a type (examStateMutex) */
+  int commissionAActiveShards = 0;
+  int commissionBActiveShards = 0;
+  ExamTimeline timeline;
 
-  /* Commission A data */
-  CommissionInfo commissionA;
+  /* Candidates admitted to and graded by each commission type, over all its
+   * shards, and graded by each shard. Updated lock-free by the commissions:
+   * the graded counts with release ordering after the scores, the completion
+   * checks read them with acquire ordering */
+  PaddedCounter commissionACandidateCount;
+  PaddedCounter commissionBCandidateCount;
+  PaddedCounter commissionAGradedCount;
+  PaddedCounter commissionBGradedCount;
+  PaddedCounter commissionAProcessed[maxCommissionShards];
+  PaddedCounter commissionBProcessed[maxCommissionShards];
 
-  /* Commission B data */
-  CommissionInfo commissionB;
+  /* Random seed of the run */
+  bool seeded = false;
+  unsigned int randomSeed = 0;
+
+  /* Commission A data, one per shard slot (including autoscaled shards) */
+  int commissionAShardCount;
+  CommissionInfo commissionA[maxCommissionShards];
+
+  /* Commission B data, one per shard slot (including autoscaled shards) */
+  int commissionBShardCount;
+  CommissionInfo commissionB[maxCommissionShards];
+
+  /* Assignment of the candidates to the shards */
+  ShardAssignment shardAssignment;
+  /* Order in which the waiting candidates receive freed seats */
+  SeatPolicy seatPolicy;
+  /* Candidates answer each question as soon as it arrives */
+  bool pipelinedAnswers = false;
 
   /* Mutexes */
   /* Candidate data */
   pthread_mutex_t candidateMutex;
-  /* Commission A data */
-  pthread_mutex_t commissionAMutex;
-  /* Commission B data */
-  pthread_mutex_t commissionBMutex;
+  /* Commission A data, one per shard */
+  pthread_mutex_t commissionAMutex[maxCommissionShards];
+  /* Commission B data, one per shard */
+  pthread_mutex_t commissionBMutex[maxCommissionShards];
   /* Exam state */
   pthread_mutex_t examStateMutex;
+  /* Signalled on examStateMutex when readyCount or examStarted changes */
+  pthread_cond_t examStateCond;
+  /* Contention counters of the mutexes above (MUTEX_PROFILING), indexed by
+   * the shard for the commission mutexes */
+  MutexStats mutexStats[SharedMutexCount][maxCommissionShards];
 
-  /* Commission PIDs */
-  pid_t commissionAPID = -1;
-  pid_t commissionBID = -1;
+  /* Live counters (examtop) */
+  LiveMetrics metrics;
+  /* Page faults taken up front by the prefault option, over all processes */
+  std::atomic<long> prefaultFaults;
 
-  /* Candidate data */
+  /* Candidate phase latencies (0 - commission A, 1 - commission B) */
+  LatencyHistogram latency[2][LatencyPhaseCount];
+
+  /* Commission PIDs, one per shard */
+  pid_t commissionAPID[maxCommissionShards];
+  pid_t commissionBID[maxCommissionShards];
+
+  /* Process group of all children of the dean, 0 until the first spawn */
+  pid_t childProcessGroup = 0;
+
+  /* Dean PID, and whether it ended the exam early on an evacuation or
+   * termination signal (examtop stops following the exam then) */
+  pid_t deanPID = 0;
+  std::atomic<bool> examInterrupted;
+
+  /* Candidate data, followed by the seats of commission A and B */
   CandidateInfo candidates[];
 };
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Monotonic timestamps (ns) of a candidate in a single commission, 0 if the
+ * phase has not been reached.
+ */
+struct PhaseTimeline {
+  uint64_t queuedAt = 0;
+  uint64_t seatedAt = 0;
+  uint64_t questionsAt = 0;
+  uint64_t answeredAt = 0;
+  uint64_t gradedAt = 0;
+};
+
+/**
+ * Monotonic timestamps (ns) of a candidate, written only by the candidate.
+ */
+struct CandidateTimeline {
+  PhaseTimeline commissions[2]; // 0 - commission A, 1 - commission B
+};
+
+/**
+ * Monotonic timestamps (ns) of the exam.
+ */
+struct ExamTimeline {
+  uint64_t spawnStartedAt = 0;
+  uint64_t spawnFinishedAt = 0;
+  uint64_t examStartedAt = 0;
+  uint64_t commissionFinishedAt[2] = {0, 0};
+};
@@ -23,4 +23,10 @@ private:
   int fileHandle_;
   std::string processPrefix_;
   sem_t *logSemaphore_ = nullptr;
+  /* Set once the semaphore has not been released in time, most likely by a
+   * process killed while logging; this process then logs without it */
+  bool semaphoreAbandoned_ = false;
+
+  /* Longest wait for the logger semaphore */
+  static const int semaphoreTimeoutMs = 1000;
 };
@@ -1,14 +1,27 @@
 #pragma once
 
+#include "common/ipc/CandidateInfo.h"
 #include <string>
 
 class ResultsWriter {
 public:
-  static void publishResults(bool evacuation);
+  static void publishResults(bool evacuation,
+                             const std::string &appendix = "");
+  static void publishResults(CandidateInfo *candidates, int count,
+                             bool evacuation, const char *path,
+                             const std::string &appendix = "");
+  static void publishTimeline();
+  static void publishMutexReport();
+  static void writeFile(const char *path, const std::string &content);
 
 private:
-  static void calculateScores(bool evacuation);
-  static std::string getTableContent(bool evacuation);
+  static void calculateScores(CandidateInfo *candidates, int count,
+                              bool evacuation);
+  static std::string getTableContent(CandidateInfo *candidates, int count,
+                                     bool evacuation);
+  static std::string getLatencyContent();
 
   static const char *fileName;
+  static const char *timelineFileName;
+  static const char *mutexReportFileName;
 };
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+/**
+ * Trace event as stored in the per-process binary trace buffers.
+ */
+struct TraceEvent {
+  uint64_t timestamp; // monotonic ns
+  uint64_t duration;  // ns, complete events only
+  int32_t pid;
+  int32_t tid;
+  int32_t arg;        // candidate index or pid, -1 if none
+  char phase;         // Chrome trace event phase: B, E, X, i or M
+  char category[11];
+  char name[40];
+};
+
+/**
+ * Trace event recorder, enabled when built with TRACING.
+ *
+ * Each process buffers its events and appends them to trace/<pid>.bin in the
+ * output directory when the buffer fills up and at exit. The dean merges the
+ * buffers into a Chrome trace JSON file that can be opened in Perfetto.
+ */
+class Tracer {
+public:
+  static void setProcessName(const std::string &name);
+  static void setThreadName(const std::string &name);
+
+  static void begin(const char *category, const char *name, int arg = -1);
+  static void end(const char *category, const char *name, int arg = -1);
+  static void complete(const char *category, const char *name,
+                       uint64_t start, uint64_t end, int arg = -1);
+  static void instant(const char *category, const char *name, int arg = -1);
+
+  static void prepareDirectory();
+  static void flush();
+  static void merge(const char *path);
+
+private:
+  Tracer();
+  ~Tracer();
+
+  static Tracer &shared();
+  void record(char phase, const char *category, const char *name,
+              uint64_t timestamp, uint64_t duration, int arg);
+  void writeEvents();
+
+  static std::string directory();
+  static const size_t bufferSize = 4096;
+
+  pthread_mutex_t mutex_;
+  std::vector<TraceEvent> events_;
+  /* Resolved up front, the namespace may be gone when writing at exit */
+  std::string directory_;
+};
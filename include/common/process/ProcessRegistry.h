@@ -4,7 +4,9 @@
 
 class ProcessRegistry {
 public:
-  static void registerCommission(pid_t pid, char commission);
+  static void registerCommission(pid_t pid, char commission, int shard);
+  static void registerProcessGroup(pid_t pgid);
+  static void markReady();
   static void unregister(pid_t pid);
   static void propagateSignal(int signal);
 };
@@ -5,7 +5,21 @@
 
 class Memory {
 public:
-  static void resetSeat(char commission, size_t seat);
+  static CommissionInfo *commission(char commission, int shard);
+  static pthread_mutex_t *commissionMutex(char commission, int shard);
+  static void resetSeat(char commission, int shard, size_t seat);
+  static void initializeCandidates();
+  static void initializeCommissions(const CommissionSize &sizeA,
+                                    const CommissionSize &sizeB);
   static void initializeMutex();
-  static CandidateInfo *findCandidate(char commissionType, int seat);
+  static void initializeCondition();
+  static CandidateInfo *findCandidate(char commissionType, int shard,
+                                     int seat);
+  static void enqueue(char commission, int shard, int index);
+  static void dequeue(char commission, int shard, int index);
+  static bool handOffSeat(char commission, int shard, int seat);
+  static void enqueueQuestions(char commission, int shard, int seat);
+  static int takeQuestion(char commission, int shard, int member);
+  static void setStatus(CandidateInfo *candidate, CandidateStatus status);
+  static CandidateScores readScores(const CandidateInfo *candidate);
 };
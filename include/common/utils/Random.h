@@ -4,6 +4,7 @@
 
 class Random {
 public:
+  static void seed(unsigned int value);
   static double randomDouble(double min, double max);
   static int randomInt(int min, int max);
   static double sampleMean(int samples, double min, double max);
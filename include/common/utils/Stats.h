@@ -0,0 +1,10 @@
+#pragma once
+
+#include <vector>
+
+class Stats {
+public:
+  static double mean(const std::vector<double> &values);
+  static double percentile(std::vector<double> values, double percent);
+  static double max(const std::vector<double> &values);
+};
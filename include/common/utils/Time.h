@@ -1,9 +1,11 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 
 class Time {
 public:
   static int seconds(const std::string &timeStr);
   static int now();
-};
\ No newline at end of file
+  static uint64_t monotonicNs();
+};
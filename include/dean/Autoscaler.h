@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Decision of the autoscaler for one commission type.
+ */
+enum ScalingAction { KeepShards = 0, SpawnShard = 1, RetireShard = 2 };
+
+/**
+ * Spawn or retire of a commission shard.
+ */
+struct ScalingEvent {
+  uint64_t timeNs;
+  char commission;
+  int shard;
+  ScalingAction action;
+  /* Candidates waiting for a seat when the decision was taken */
+  int queued;
+  /* Shards open to candidates after the event */
+  int openShards;
+};
+
+/**
+ * Queue-depth driven scaling policy of the commission shards. The dean
+ * samples the number of candidates waiting for a seat of each commission
+ * type; a shard is added while there are more waiters per open shard than
+ * the threshold, and an elastic shard is retired once the queue has stayed
+ * empty for idleSamples consecutive samples.
+ */
+class Autoscaler {
+public:
+  Autoscaler(int threshold = 0, int idleSamples = 4);
+
+  ScalingAction decide(int commission, int queued, int openShards,
+                       int minShards, int maxShards);
+  void record(const ScalingEvent &event);
+  std::string getTableContent(uint64_t startNs) const;
+
+private:
+  int threshold_;
+  int idleSamples_;
+  /* Consecutive samples with an empty queue, per commission type */
+  int idle_[2] = {0, 0};
+  std::vector<ScalingEvent> events_;
+};
@@ -1,19 +1,34 @@
 #pragma once
 
+#include "common/ipc/CommissionTraits.h"
 #include <string>
+#include <vector>
 
 class DeanConfig {
 public:
   DeanConfig();
-  DeanConfig(int places, int startTime);
+  DeanConfig(int places, int startTime,
+             CommissionSize sizeA = {CommissionA::defaultSeatCount,
+                                     CommissionA::defaultMemberCount,
+                                     CommissionA::defaultShardCount,
+                                     CommissionA::defaultShardCount},
+             CommissionSize sizeB = {CommissionB::defaultSeatCount,
+                                     CommissionB::defaultMemberCount,
+                                     CommissionB::defaultShardCount,
+                                     CommissionB::defaultShardCount});
 
   int placeCount;
   int startTime;
   int candidateCount;
   int failedExamCount;
   int retakeExamCount;
-  double timesA[5];
-  double timesB[3];
+  CommissionSize sizeA;
+  CommissionSize sizeB;
+  /* Answer time for the question of each member */
+  std::vector<double> timesA;
+  std::vector<double> timesB;
+
+  static std::string join(const std::vector<double> &times);
 
 private:
   void printConfig();
@@ -1,9 +1,13 @@
 #pragma once
 
 #include "common/process/BaseProcess.h"
+#include "dean/Autoscaler.h"
 #include "dean/DeanConfig.h"
+#include "dean/ResourceUsage.h"
 #include <atomic>
 #include <pthread.h>
+#include <signal.h>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -19,6 +23,7 @@ public:
   void handleError(const char *message) override;
 
   void spawnComissions();
+  void spawnCommission(char commission, int shard);
   void spawnCandidates();
   void verifyCandidates();
   void waitForExamStart();
@@ -28,17 +33,70 @@ private:
   std::unordered_set<int> getFailedExamIndices();
   std::unordered_set<int>
   getRetakeExamIndices(std::unordered_set<int> excludedIndices);
-  static void evacuationHandler(int signal);
-  static void terminationHandler(int signal);
   static void *cleanupThreadFunction(void *arg);
+  void signalReceived(int signal);
+  void handlePendingSignal();
+  void startCleanupThread();
   void stopCleanupThread();
+  pid_t forkChild(const char *processType);
+  void reapChildren();
+  void childReaped(pid_t pid, const struct rusage &usage);
+  void waitForChild(pid_t pid);
+  bool waitForChildren(int timeoutMs);
+  void terminateChildren();
+  static void *autoscalerThreadFunction(void *arg);
+  void startAutoscalerThread();
+  void stopAutoscalerThread();
+  void scaleCommissions();
+  bool activateShard(char commission, int shard);
+
+  /* Time given to the children to exit after SIGTERM and after SIGKILL */
+  static const int teardownTimeoutMs = 3000;
+  /* Time given to the children to exit on their own after the exam ends */
+  static const int examEndTimeoutMs = 5000;
+  /* Longest wait of the main thread before it checks for a signal */
+  static const int signalPollMs = 100;
+  /* Time given to the participants to attach before the exam starts */
+  static const int readinessTimeoutMs = 30000;
+  /* Limits of the commission sizes (-s, -a, -b) */
+  static const int maxSeatCount = 1024;
+  static const int maxMemberCount = maxCommissionMembers;
+  /* Interval between samples of the commission queues */
+  static const int scalingIntervalMs = 500;
 
   int candidateCount;
   int retaking = 0;
+  int rejected = 0;
+  bool seeded = false;
+  unsigned int seed = 0;
+  ShardAssignment shardAssignment = LeastLoadedAssignment;
+  SeatPolicy seatPolicy = FifoSeatPolicy;
+  /* Answer times drawn for every candidate instead of once (-j) */
+  bool perCandidateTimes = false;
+  /* Questions answered as soon as they arrive (-o) */
+  bool pipelinedAnswers = false;
   DeanConfig config;
 
-  std::vector<pid_t> childPids;
+  /* Child pid -> process type */
+  std::unordered_map<pid_t, const char *> childPids;
   pthread_mutex_t childPidsMutex;
+  /* Resource usage of the reaped children */
+  ResourceUsageReport resourceUsage;
+  /* Signalled whenever a child is reaped */
+  pthread_cond_t childReapedCond;
   std::atomic<bool> cleanupRunning;
   pthread_t cleanupThread;
+  /* Spawns and retires the elastic commission shards (-e) */
+  Autoscaler autoscaler;
+  std::atomic<bool> autoscalerRunning = false;
+  pthread_t autoscalerThread;
+
+  /* SIGCHLD and the termination and evacuation signals are blocked in the
+   * dean and consumed through signalFd by the cleanup thread */
+  sigset_t originalSignalMask;
+  /* Termination or evacuation signal to be handled by the main thread, 0 if
+   * none has arrived */
+  std::atomic<int> pendingSignal = 0;
+  int signalFd = -1;
+  int stopFd = -1;
 };
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <sys/resource.h>
+#include <vector>
+
+/**
+ * Resource usage of a reaped child process.
+ */
+struct ResourceUsage {
+  double userSeconds = 0.0;
+  double systemSeconds = 0.0;
+  long maxRssKb = 0;
+  long voluntarySwitches = 0;
+  long involuntarySwitches = 0;
+  long minorFaults = 0;
+  long majorFaults = 0;
+
+  static ResourceUsage fromRusage(const struct rusage &usage);
+};
+
+/**
+ * Resource usage of the exam processes aggregated per process type.
+ */
+class ResourceUsageReport {
+public:
+  void add(const std::string &processType, const ResourceUsage &usage);
+  std::string getTableContent() const;
+
+private:
+  std::map<std::string, std::vector<ResourceUsage>> samples_;
+};
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "common/ipc/CandidateInfo.h"
+#include "dean/DeanConfig.h"
+#include <cstdint>
+#include <deque>
+#include <queue>
+#include <string>
+#include <vector>
+
+/**
+ * Simulation parameters.
+ */
+struct SimulationConfig {
+  int placeCount = 0;
+  int seatCount = 3;
+  int membersA = 5;
+  int membersB = 3;
+  /* Answer time range, used for members without a time in DeanConfig */
+  double answerTimeMin = 0.25;
+  double answerTimeMax = 1.0;
+  /* Redraw all answer times from the range above */
+  bool customAnswerTimes = false;
+  bool seeded = false;
+  unsigned int seed = 0;
+};
+
+/**
+ * Simulation event type.
+ */
+enum SimulationEventType {
+  CandidateArrival = 0,
+  MemberScan = 1,
+  QuestionsNoticed = 2,
+  AnswersReady = 3,
+  CommissionTick = 4,
+  GradeNoticed = 5,
+};
+
+/**
+ * Simulation event, ordered by time and then by insertion order.
+ */
+struct SimulationEvent {
+  double time;
+  uint64_t sequence;
+  SimulationEventType type;
+  int commission; // 0 - commission A, 1 - commission B
+  int target;     // candidate index or member id
+
+  bool operator>(const SimulationEvent &other) const {
+    return time != other.time ? time > other.time : sequence > other.sequence;
+  }
+};
+
+/**
+ * Simulated commission seat.
+ */
+struct SimulatedSeat {
+  int candidate = -1; // -1 if seat is empty
+  uint64_t questions = 0;
+  bool answered = false;
+};
+
+/**
+ * Simulated commission.
+ */
+struct SimulatedCommission {
+  char type;
+  int memberCount;
+  uint64_t fullMask;
+  double answerTime;
+  std::vector<SimulatedSeat> seats;
+  std::vector<int> freeSeats;
+  std::deque<int> queue;
+  int expected = 0;
+  int processed = 0;
+  bool finished = false;
+  double finishedAt = 0.0;
+  double busySeatTime = 0.0;
+};
+
+/**
+ * Per-candidate phase timestamps (in seconds since exam start).
+ */
+struct SimulatedTimeline {
+  int seat = -1;
+  double queuedAt[2] = {-1.0, -1.0};
+  double seatedAt[2] = {-1.0, -1.0};
+  double questionsAt[2] = {-1.0, -1.0};
+  double answeredAt[2] = {-1.0, -1.0};
+  double gradedAt[2] = {-1.0, -1.0};
+};
+
+/**
+ * Single-process discrete-event model of the exam. Candidates, commission
+ * seats and commission members are modelled as events in a binary heap, using
+ * the same timing rules as the process-based simulation.
+ */
+class ExamSimulator {
+public:
+  explicit ExamSimulator(const SimulationConfig &config);
+
+  void run();
+  void publishResults(const char *path);
+  std::string getStatistics();
+
+private:
+  void schedule(double time, SimulationEventType type, int commission,
+                int target);
+  void handleEvent(const SimulationEvent &event);
+  void assignSeats(int commission, double now);
+  void scanSeats(int commission, int member, double now);
+  void gradeCandidate(int commission, double now);
+  void maybeFinish(int commission, double now);
+
+  SimulationConfig simulation;
+  DeanConfig config;
+  std::vector<CandidateInfo> candidates;
+  std::vector<SimulatedTimeline> timelines;
+  SimulatedCommission commissions[2];
+  std::priority_queue<SimulationEvent, std::vector<SimulationEvent>,
+                      std::greater<SimulationEvent>>
+      events;
+  uint64_t nextSequence = 0;
+  uint64_t processedEvents = 0;
+  double makespan = 0.0;
+  double wallTime = 0.0;
+};
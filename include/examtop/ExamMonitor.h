@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/**
+ * Read-only monitor of a running exam. Attaches to the shared memory without
+ * write access and samples the live counters without taking any of the
+ * simulation's mutexes.
+ */
+class ExamMonitor {
+public:
+  ExamMonitor();
+  ~ExamMonitor();
+
+  std::string snapshot();
+  bool finished() const;
+
+private:
+  uint64_t lastSampleAt_ = 0;
+  int lastGraded_[2] = {0, 0};
+};
@@ -0,0 +1,233 @@
+#include "bench_exam/ExamBenchmark.h"
+
+#include "common/ipc/Namespace.h"
+#include "common/utils/Stats.h"
+#include "common/utils/Time.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * Constructor for the exam benchmark.
+ *
+ * @param placeCount The number of places passed to the dean.
+ * @param seed The random seed passed to the dean.
+ * @param seatCount The number of seats of each commission.
+ * @param seatPolicy The seat policy passed to the dean, empty for the default.
+ */
+ExamBenchmark::ExamBenchmark(int placeCount, unsigned int seed, int seatCount,
+                             const std::string &seatPolicy)
+    : placeCount_(placeCount), seed_(seed), seatCount_(seatCount),
+      seatPolicy_(seatPolicy) {}
+
+/**
+ * Runs the exam and summarises it.
+ *
+ * @return The summary formatted as JSON.
+ * @throw std::runtime_error If the exam fails or its timeline cannot be read.
+ */
+std::string ExamBenchmark::run() {
+  launchDean();
+  readTimeline(Namespace::outputPath("timeline.csv").c_str());
+
+  std::map<std::string, size_t> column;
+  for (size_t i = 0; i < columns_.size(); i++) {
+    column[columns_[i]] = i;
+  }
+
+  auto durations = [&](const std::string &from, const std::string &to) {
+    std::vector<double> values;
+    for (const std::vector<double> &row : rows_) {
+      double start = row[column.at(from)];
+      double end = row[column.at(to)];
+      if (start >= 0.0 && end >= 0.0) {
+        values.push_back(end - start);
+      }
+    }
+    return values;
+  };
+
+  /* Time spent waiting for a seat, over both commissions */
+  std::vector<double> seatWaits = durations("queued_a", "seated_a");
+  for (double wait : durations("queued_b", "seated_b")) {
+    seatWaits.push_back(wait);
+  }
+
+  char buffer[512];
+  snprintf(buffer, sizeof(buffer),
+           "{\n  \"place_count\": %d,\n  \"seed\": %u,\n  \"seat_count\": %d,"
+           "\n  \"seat_policy\": \"%s\",\n  \"candidates\": %zu,\n  "
+           "\"wall_s\": %.3f,\n  \"spawn_s\": %.3f,\n  \"makespan_s\": %.3f,"
+           "\n  \"mean_seat_wait_s\": %.3f,\n  \"p99_seat_wait_s\": %.3f,\n",
+           placeCount_, seed_, seatCount_,
+           seatPolicy_.empty() ? "fifo" : seatPolicy_.c_str(), rows_.size(),
+           wallSeconds_, examTimings_["spawn_s"],
+           examTimings_["commission_b_s"], Stats::mean(seatWaits),
+           Stats::percentile(seatWaits, 99.0));
+  std::string json = buffer;
+
+  json += "  \"commissions\": {\n";
+  for (const char *commission : {"a", "b"}) {
+    std::vector<double> graded =
+        durations(std::string("queued_") + commission,
+                  std::string("graded_") + commission);
+    double duration = examTimings_[std::string("commission_") + commission +
+                                   "_s"];
+    snprintf(buffer, sizeof(buffer),
+             "    \"%s\": {\"graded\": %zu, \"duration_s\": %.3f, "
+             "\"throughput_per_s\": %.3f}%s\n",
+             commission, graded.size(), duration,
+             duration > 0.0 ? graded.size() / duration : 0.0,
+             commission[0] == 'a' ? "," : "");
+    json += buffer;
+  }
+  json += "  },\n";
+
+  json += "  \"phases\": {\n";
+  for (const char *commission : {"a", "b"}) {
+    std::string suffix = std::string("_") + commission;
+    json += phaseJson("seat_wait" + suffix,
+                      durations("queued" + suffix, "seated" + suffix)) +
+            ",\n";
+    json += phaseJson("question_wait" + suffix,
+                      durations("seated" + suffix, "questions" + suffix)) +
+            ",\n";
+    json += phaseJson("answering" + suffix,
+                      durations("questions" + suffix, "answered" + suffix)) +
+            ",\n";
+    json += phaseJson("grading_wait" + suffix,
+                      durations("answered" + suffix, "graded" + suffix)) +
+            (commission[0] == 'a' ? ",\n" : "\n");
+  }
+  json += "  }\n}\n";
+
+  return json;
+}
+
+/**
+ * Launches the dean without a start time, so that the exam starts as soon as
+ * every participant is ready, and waits for it to finish. A seat policy run
+ * draws the answer times per candidate (-j), so that the policies have
+ * different jobs to order.
+ *
+ * @throw std::runtime_error If the dean cannot be launched or fails.
+ */
+void ExamBenchmark::launchDean() {
+  std::string places = std::to_string(placeCount_);
+  std::string seed = std::to_string(seed_);
+  std::string seats = std::to_string(seatCount_);
+
+  uint64_t start = Time::monotonicNs();
+
+  pid_t pid = fork();
+  if (pid < 0) {
+    throw std::runtime_error("Failed in fork() call for dean: " +
+                             std::string(std::strerror(errno)));
+  }
+
+  if (pid == 0) {
+    /* The simulation log is kept in simulation.log */
+    int devNull = open("/dev/null", O_WRONLY);
+    if (devNull != -1) {
+      dup2(devNull, STDOUT_FILENO);
+      close(devNull);
+    }
+
+    if (seatPolicy_.empty()) {
+      execl("./dean", "./dean", "-s", seats.c_str(), places.c_str(),
+            seed.c_str(), NULL);
+    } else {
+      execl("./dean", "./dean", "-s", seats.c_str(), "-p",
+            seatPolicy_.c_str(), "-j", places.c_str(), seed.c_str(), NULL);
+    }
+    perror("Failed in execl() call for dean");
+    _exit(1);
+  }
+
+  int status;
+  if (waitpid(pid, &status, 0) == -1) {
+    throw std::runtime_error("Failed to wait for dean: " +
+                             std::string(std::strerror(errno)));
+  }
+
+  wallSeconds_ = (Time::monotonicNs() - start) / 1e9;
+
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    throw std::runtime_error("Dean exited with failure status " +
+                             std::to_string(status));
+  }
+}
+
+/**
+ * Reads the timeline published by the dean.
+ *
+ * @param path The path of the timeline file.
+ * @throw std::runtime_error If the file cannot be read.
+ */
+void ExamBenchmark::readTimeline(const char *path) {
+  std::ifstream file(path);
+  if (!file) {
+    throw std::runtime_error("Failed to open timeline " + std::string(path));
+  }
+
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.empty()) {
+      continue;
+    }
+
+    /* Exam-level timings: # key=value */
+    if (line[0] == '#') {
+      size_t equals = line.find('=');
+      if (equals != std::string::npos) {
+        examTimings_[line.substr(2, equals - 2)] =
+            std::stod(line.substr(equals + 1));
+      }
+      continue;
+    }
+
+    std::stringstream ss(line);
+    std::string cell;
+
+    if (columns_.empty()) {
+      while (std::getline(ss, cell, ',')) {
+        columns_.push_back(cell);
+      }
+      continue;
+    }
+
+    std::vector<double> row;
+    while (std::getline(ss, cell, ',')) {
+      row.push_back(std::stod(cell));
+    }
+    if (row.size() != columns_.size()) {
+      throw std::runtime_error("Malformed timeline row: " + line);
+    }
+    rows_.push_back(row);
+  }
+}
+
+/**
+ * Formats the latency distribution of a phase as a JSON member.
+ *
+ * @param name The name of the phase.
+ * @param values The latencies in seconds.
+ * @return The JSON member.
+ */
+std::string ExamBenchmark::phaseJson(const std::string &name,
+                                     const std::vector<double> &values) {
+  char buffer[256];
+  snprintf(buffer, sizeof(buffer),
+           "    \"%s\": {\"count\": %zu, \"mean_s\": %.3f, \"p50_s\": %.3f, "
+           "\"p95_s\": %.3f, \"p99_s\": %.3f, \"max_s\": %.3f}",
+           name.c_str(), values.size(), Stats::mean(values),
+           Stats::percentile(values, 50.0), Stats::percentile(values, 95.0),
+           Stats::percentile(values, 99.0), Stats::max(values));
+  return buffer;
+}
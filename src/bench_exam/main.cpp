@@ -0,0 +1,120 @@
+#include "bench_exam/ExamBenchmark.h"
+
+#include "common/ipc/CommissionTraits.h"
+#include "common/ipc/SeatScheduler.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+const char *usage =
+    "Usage: ./bench_exam <place count> [-s seats[,seats...]] "
+    "[-p policy[,policy...]] [-r seed] [-o output file]";
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  int placeCount = 0;
+  unsigned int seed = 1;
+  std::string outputPath = "";
+  std::vector<int> seatCounts = {CommissionA::defaultSeatCount};
+  std::vector<std::string> seatPolicies = {""};
+
+  try {
+    int option;
+    while ((option = getopt(argc, argv, "s:p:r:o:")) != -1) {
+      switch (option) {
+      case 's': {
+        /* One exam per seat count, for the throughput curve */
+        seatCounts.clear();
+        std::stringstream ss(optarg);
+        std::string seats;
+        while (std::getline(ss, seats, ',')) {
+          seatCounts.push_back(std::stoi(seats));
+        }
+        break;
+      }
+      case 'p': {
+        /* One exam per seat policy, on the same workload */
+        seatPolicies.clear();
+        std::stringstream ss(optarg);
+        std::string policy;
+        while (std::getline(ss, policy, ',')) {
+          SeatScheduler::parse(policy);
+          seatPolicies.push_back(policy);
+        }
+        break;
+      }
+      case 'r':
+        seed = static_cast<unsigned int>(std::stoul(optarg));
+        break;
+      case 'o':
+        outputPath = optarg;
+        break;
+      default:
+        throw std::invalid_argument(usage);
+      }
+    }
+
+    if (optind != argc - 1) {
+      throw std::invalid_argument(usage);
+    }
+
+    /* Expected value: n > 0, further validated by the dean */
+    placeCount = std::stoi(argv[optind]);
+    if (placeCount <= 0) {
+      throw std::invalid_argument("Invalid place count. Expected: 0 < n");
+    }
+
+    /* Expected value: n > 0, further validated by the dean */
+    for (int seatCount : seatCounts) {
+      if (seatCount <= 0) {
+        throw std::invalid_argument("Invalid seat count. Expected: 0 < n");
+      }
+    }
+    if (seatCounts.empty() || seatPolicies.empty()) {
+      throw std::invalid_argument(usage);
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "Failed to validate arguments: \n\t" << e.what() << std::endl;
+    return 1;
+  }
+
+  try {
+    /* A sweep over several seat counts or policies is reported as an array
+     * of runs */
+    std::string json;
+    size_t runCount = seatCounts.size() * seatPolicies.size();
+    for (size_t i = 0; i < runCount; i++) {
+      ExamBenchmark benchmark(placeCount, seed,
+                              seatCounts[i / seatPolicies.size()],
+                              seatPolicies[i % seatPolicies.size()]);
+      std::string run = benchmark.run();
+      if (runCount > 1) {
+        run.pop_back();
+        run = (i == 0 ? "[\n" : ",\n") + run +
+              (i + 1 == runCount ? "\n]\n" : "");
+      }
+      json += run;
+    }
+    std::cout << json;
+
+    if (!outputPath.empty()) {
+      std::ofstream output(outputPath);
+      output << json;
+      if (!output) {
+        throw std::runtime_error("Failed to write " + outputPath);
+      }
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "Benchmark failed: " << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
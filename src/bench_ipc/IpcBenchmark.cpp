@@ -0,0 +1,531 @@
+#include "bench_ipc/IpcBenchmark.h"
+
+#include "common/ipc/MutexWrapper.h"
+#include "common/ipc/SemaphoreManager.h"
+#include "common/ipc/SharedState.h"
+#include "common/utils/Stats.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <new>
+#include <sched.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/shm.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+/* Segment size of an exam with 1000 candidates */
+const size_t benchmarkShmSize =
+    sizeof(SharedState) + sizeof(CandidateInfo) * 1000;
+
+uint64_t monotonicNs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+long futexCall(std::atomic<int> *word, int operation, int value) {
+  return syscall(SYS_futex, reinterpret_cast<int *>(word), operation, value,
+                 nullptr, nullptr, 0);
+}
+
+/* SECTION: Lock primitives */
+
+void noSetup(BenchmarkShared *) {}
+
+void noTeardown(BenchmarkShared *) {}
+
+void mutexSetup(BenchmarkShared *shared) {
+  pthread_mutexattr_t attr;
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+  int result = pthread_mutex_init(&shared->mutex, &attr);
+  pthread_mutexattr_destroy(&attr);
+  if (result != 0) {
+    throw std::runtime_error("Failed to initialize mutex: " +
+                             std::string(std::strerror(result)));
+  }
+}
+
+void mutexTeardown(BenchmarkShared *shared) {
+  pthread_mutex_destroy(&shared->mutex);
+}
+
+void mutexOperation(BenchmarkShared *shared) {
+  MutexWrapper::lock(&shared->mutex);
+  shared->counter++;
+  MutexWrapper::unlock(&shared->mutex);
+}
+
+/* Three-state futex lock (0 - free, 1 - locked, 2 - locked with waiters) */
+void futexOperation(BenchmarkShared *shared) {
+  int expected = 0;
+  if (!shared->futex.compare_exchange_strong(expected, 1,
+                                             std::memory_order_acquire)) {
+    if (expected != 2) {
+      expected = shared->futex.exchange(2, std::memory_order_acquire);
+    }
+    while (expected != 0) {
+      futexCall(&shared->futex, FUTEX_WAIT, 2);
+      expected = shared->futex.exchange(2, std::memory_order_acquire);
+    }
+  }
+
+  shared->counter++;
+
+  if (shared->futex.fetch_sub(1, std::memory_order_release) != 1) {
+    shared->futex.store(0, std::memory_order_release);
+    futexCall(&shared->futex, FUTEX_WAKE, 1);
+  }
+}
+
+void spinSetup(BenchmarkShared *shared) { shared->spin.clear(); }
+
+void spinOperation(BenchmarkShared *shared) {
+  int spins = 0;
+  while (shared->spin.test_and_set(std::memory_order_acquire)) {
+    /* Yield periodically so that the holder can run on a busy host */
+    if (++spins % 100 == 0) {
+      sched_yield();
+    }
+  }
+
+  shared->counter++;
+
+  shared->spin.clear(std::memory_order_release);
+}
+
+void unnamedSemaphoreSetup(BenchmarkShared *shared) {
+  if (sem_init(&shared->unnamedSemaphore, 1, 1) == -1) {
+    throw std::runtime_error("Failed to initialize unnamed semaphore: " +
+                             std::string(std::strerror(errno)));
+  }
+}
+
+void unnamedSemaphoreTeardown(BenchmarkShared *shared) {
+  sem_destroy(&shared->unnamedSemaphore);
+}
+
+void unnamedSemaphoreOperation(BenchmarkShared *shared) {
+  SemaphoreManager::wait(&shared->unnamedSemaphore);
+  shared->counter++;
+  SemaphoreManager::post(&shared->unnamedSemaphore);
+}
+
+void namedSemaphoreSetup(BenchmarkShared *shared) {
+  shared->namedSemaphore = SemaphoreManager::create(shared->semaphoreName, 1);
+}
+
+void namedSemaphoreTeardown(BenchmarkShared *shared) {
+  SemaphoreManager::close(shared->namedSemaphore);
+  SemaphoreManager::unlink(shared->semaphoreName);
+  shared->namedSemaphore = nullptr;
+}
+
+void namedSemaphoreOperation(BenchmarkShared *shared) {
+  SemaphoreManager::wait(shared->namedSemaphore);
+  shared->counter++;
+  SemaphoreManager::post(shared->namedSemaphore);
+}
+
+/* Seat acquisition as it was before the ticket queue: sem_open per call */
+void semOpenPerCallOperation(BenchmarkShared *shared) {
+  sem_t *semaphore = SemaphoreManager::open(shared->semaphoreName);
+  SemaphoreManager::wait(semaphore);
+  shared->counter++;
+  SemaphoreManager::post(semaphore);
+  SemaphoreManager::close(semaphore);
+}
+
+/* END SECTION: Lock primitives */
+
+/* SECTION: Shared memory primitives */
+
+void shmgetSetup(BenchmarkShared *shared) {
+  shared->shmId =
+      shmget(shared->shmKey, shared->shmSize, IPC_CREAT | IPC_EXCL | 0600);
+  if (shared->shmId == -1) {
+    throw std::runtime_error("Failed to create shared memory: " +
+                             std::string(std::strerror(errno)));
+  }
+}
+
+void shmgetTeardown(BenchmarkShared *shared) {
+  shmctl(shared->shmId, IPC_RMID, nullptr);
+  shared->shmId = -1;
+}
+
+/* System V attach and detach, used before the shm_open backend */
+void shmgetOperation(BenchmarkShared *shared) {
+  int shmId = shmget(shared->shmKey, 0, 0600);
+  void *data = shmat(shmId, nullptr, 0);
+  if (data == (void *)-1) {
+    throw std::runtime_error("Failed to attach to shared memory");
+  }
+  shmdt(data);
+}
+
+void shmOpenSetup(BenchmarkShared *shared) {
+  int fd = shm_open(shared->shmName, O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd == -1) {
+    throw std::runtime_error("Failed to create POSIX shared memory: " +
+                             std::string(std::strerror(errno)));
+  }
+  if (ftruncate(fd, shared->shmSize) == -1) {
+    close(fd);
+    throw std::runtime_error("Failed to resize POSIX shared memory: " +
+                             std::string(std::strerror(errno)));
+  }
+  close(fd);
+}
+
+void shmOpenTeardown(BenchmarkShared *shared) { shm_unlink(shared->shmName); }
+
+/* Pattern of SharedMemoryManager::attach() and detach() */
+void shmOpenOperation(BenchmarkShared *shared) {
+  int fd = shm_open(shared->shmName, O_RDWR, 0600);
+  struct stat st;
+  fstat(fd, &st);
+  void *data =
+      mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    throw std::runtime_error("Failed to map POSIX shared memory");
+  }
+  munmap(data, st.st_size);
+}
+
+/* END SECTION: Shared memory primitives */
+
+const BenchmarkCase benchmarkCases[] = {
+    {"mutex_wrapper", 1, mutexSetup, mutexOperation, mutexTeardown},
+    {"futex_lock", 1, noSetup, futexOperation, noTeardown},
+    {"spin_lock", 1, spinSetup, spinOperation, noTeardown},
+    {"unnamed_semaphore", 1, unnamedSemaphoreSetup, unnamedSemaphoreOperation,
+     unnamedSemaphoreTeardown},
+    {"named_semaphore", 1, namedSemaphoreSetup, namedSemaphoreOperation,
+     namedSemaphoreTeardown},
+    {"sem_open_per_call", 10, namedSemaphoreSetup, semOpenPerCallOperation,
+     namedSemaphoreTeardown},
+    {"shmget_attach", 10, shmgetSetup, shmgetOperation, shmgetTeardown},
+    {"shm_open_mmap", 10, shmOpenSetup, shmOpenOperation, shmOpenTeardown},
+};
+
+struct ThreadArgs {
+  const BenchmarkCase *benchmarkCase;
+  BenchmarkShared *shared;
+  int iterations;
+  uint64_t *latencies;
+};
+
+/**
+ * Latency buffer of a benchmark run, shared with worker processes. Unmapped
+ * when the run ends, including when it throws.
+ */
+class LatencyBuffer {
+public:
+  explicit LatencyBuffer(size_t count) : size_(sizeof(uint64_t) * count) {
+    void *memory = mmap(nullptr, size_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+      throw std::runtime_error("Failed to map latency buffer: " +
+                               std::string(std::strerror(errno)));
+    }
+    data_ = static_cast<uint64_t *>(memory);
+  }
+
+  ~LatencyBuffer() { munmap(data_, size_); }
+
+  LatencyBuffer(const LatencyBuffer &) = delete;
+  LatencyBuffer &operator=(const LatencyBuffer &) = delete;
+
+  uint64_t *data() const { return data_; }
+
+private:
+  size_t size_;
+  uint64_t *data_ = nullptr;
+};
+
+} // namespace
+
+/**
+ * Constructor for the IPC benchmark.
+ *
+ * @param maxWorkers The maximum number of contending workers.
+ * @param iterations The number of operations per worker.
+ * @param filter Only benchmarks containing this string are run.
+ * @param processes Whether to run the benchmarks with worker processes.
+ * @param threads Whether to run the benchmarks with worker threads.
+ * @throw std::runtime_error If the shared state cannot be mapped.
+ */
+IpcBenchmark::IpcBenchmark(int maxWorkers, int iterations,
+                           const std::string &filter, bool processes,
+                           bool threads)
+    : maxWorkers_(maxWorkers), iterations_(iterations), filter_(filter),
+      processes_(processes), threads_(threads) {
+  void *memory = mmap(nullptr, sizeof(BenchmarkShared), PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED) {
+    throw std::runtime_error("Failed to map benchmark state: " +
+                             std::string(std::strerror(errno)));
+  }
+
+  shared_ = new (memory) BenchmarkShared();
+  shared_->shmKey = 0x42000000 | (getpid() & 0xffffff);
+  shared_->shmId = -1;
+  shared_->shmSize = benchmarkShmSize;
+  snprintf(shared_->shmName, sizeof(shared_->shmName), "/bench_ipc.%d",
+           getpid());
+  snprintf(shared_->semaphoreName, sizeof(shared_->semaphoreName),
+           "/bench_ipc.%d.sem", getpid());
+}
+
+IpcBenchmark::~IpcBenchmark() {
+  if (shared_ != nullptr) {
+    munmap(shared_, sizeof(BenchmarkShared));
+    shared_ = nullptr;
+  }
+}
+
+/**
+ * Runs all selected benchmarks.
+ *
+ * @return The results formatted as JSON.
+ */
+std::string IpcBenchmark::run() {
+  std::vector<BenchmarkResult> results;
+
+  for (const BenchmarkCase &benchmarkCase : benchmarkCases) {
+    if (std::string(benchmarkCase.name).find(filter_) == std::string::npos) {
+      continue;
+    }
+
+    for (int workers = 1; workers <= maxWorkers_; workers++) {
+      if (threads_) {
+        results.push_back(runCase(benchmarkCase, workers, false));
+      }
+      if (processes_) {
+        results.push_back(runCase(benchmarkCase, workers, true));
+      }
+    }
+  }
+
+  char header[256];
+  snprintf(header, sizeof(header),
+           "{\n  \"timestamp\": %ld,\n  \"cpus\": %ld,\n  \"iterations\": %d,"
+           "\n  \"timer_overhead_ns\": %.1f,\n  \"results\": [\n",
+           static_cast<long>(std::time(nullptr)), sysconf(_SC_NPROCESSORS_ONLN),
+           iterations_, timerOverhead());
+
+  std::string json = header;
+  for (size_t i = 0; i < results.size(); i++) {
+    json += "    " + toJson(results[i]) + (i + 1 < results.size() ? ",\n" : "\n");
+  }
+  json += "  ]\n}\n";
+
+  return json;
+}
+
+/**
+ * Runs a single benchmark with the given number of workers.
+ *
+ * @param benchmarkCase The benchmark.
+ * @param workers The number of contending workers.
+ * @param processes Whether the workers are processes (or threads).
+ * @return The result of the benchmark.
+ * @throw std::runtime_error If a worker cannot be started or fails.
+ */
+BenchmarkResult IpcBenchmark::runCase(const BenchmarkCase &benchmarkCase,
+                                      int workers, bool processes) {
+  int iterations = std::max(1, iterations_ / benchmarkCase.iterationDivisor);
+  LatencyBuffer buffer(static_cast<size_t>(iterations) * workers);
+  uint64_t *latencies = buffer.data();
+
+  shared_->ready = 0;
+  shared_->go = false;
+  shared_->counter = 0;
+  benchmarkCase.setup(shared_);
+
+  std::vector<pid_t> pids;
+  std::vector<pthread_t> threadIds(workers);
+  std::vector<ThreadArgs> threadArgs(workers);
+  int started = 0;
+
+  try {
+    for (int i = 0; i < workers; i++) {
+      uint64_t *workerLatencies =
+          latencies + static_cast<size_t>(i) * iterations;
+
+      if (processes) {
+        pid_t pid = fork();
+        if (pid < 0) {
+          throw std::runtime_error(
+              "Failed in fork() call for benchmark worker");
+        }
+
+        if (pid == 0) {
+          try {
+            runWorker(benchmarkCase, shared_, iterations, workerLatencies);
+          } catch (const std::exception &e) {
+            fprintf(stderr, "Benchmark worker failed: %s\n", e.what());
+            _exit(1);
+          }
+          _exit(0);
+        }
+
+        pids.push_back(pid);
+      } else {
+        threadArgs[i] = {&benchmarkCase, shared_, iterations, workerLatencies};
+        int result = pthread_create(&threadIds[i], nullptr, threadFunction,
+                                    &threadArgs[i]);
+        if (result != 0) {
+          throw std::runtime_error("Failed to create benchmark thread: " +
+                                   std::string(std::strerror(result)));
+        }
+      }
+      started++;
+    }
+  } catch (...) {
+    /* The started workers wait on the start barrier, let them run through */
+    shared_->go = true;
+    for (pid_t pid : pids) {
+      waitpid(pid, nullptr, 0);
+    }
+    for (int i = 0; !processes && i < started; i++) {
+      pthread_join(threadIds[i], nullptr);
+    }
+    benchmarkCase.teardown(shared_);
+    throw;
+  }
+
+  while (shared_->ready.load() < workers) {
+    sched_yield();
+  }
+
+  uint64_t start = monotonicNs();
+  shared_->go = true;
+
+  bool failed = false;
+  if (processes) {
+    for (pid_t pid : pids) {
+      int status;
+      if (waitpid(pid, &status, 0) == -1 || !WIFEXITED(status) ||
+          WEXITSTATUS(status) != 0) {
+        failed = true;
+      }
+    }
+  } else {
+    for (pthread_t threadId : threadIds) {
+      pthread_join(threadId, nullptr);
+    }
+  }
+
+  uint64_t end = monotonicNs();
+  benchmarkCase.teardown(shared_);
+
+  if (failed) {
+    throw std::runtime_error(std::string("Benchmark worker failed in ") +
+                             benchmarkCase.name);
+  }
+
+  std::vector<double> samples(latencies,
+                              latencies + static_cast<size_t>(iterations) *
+                                              workers);
+
+  BenchmarkResult result;
+  result.name = benchmarkCase.name;
+  result.mode = processes ? "process" : "thread";
+  result.workers = workers;
+  result.iterations = iterations;
+  result.wallSeconds = (end - start) / 1e9;
+  result.nsPerOp = Stats::mean(samples);
+  result.opsPerSecond = samples.size() / result.wallSeconds;
+  result.p50 = Stats::percentile(samples, 50.0);
+  result.p90 = Stats::percentile(samples, 90.0);
+  result.p99 = Stats::percentile(samples, 99.0);
+  result.p999 = Stats::percentile(samples, 99.9);
+  result.max = Stats::max(samples);
+
+  return result;
+}
+
+/**
+ * Performs the benchmarked operation, recording the latency of every call.
+ *
+ * @param benchmarkCase The benchmark.
+ * @param shared The shared benchmark state.
+ * @param iterations The number of operations.
+ * @param latencies The latency buffer of the worker.
+ */
+void IpcBenchmark::runWorker(const BenchmarkCase &benchmarkCase,
+                             BenchmarkShared *shared, int iterations,
+                             uint64_t *latencies) {
+  shared->ready++;
+  while (!shared->go.load(std::memory_order_acquire)) {
+    sched_yield();
+  }
+
+  for (int i = 0; i < iterations; i++) {
+    uint64_t start = monotonicNs();
+    benchmarkCase.operation(shared);
+    latencies[i] = monotonicNs() - start;
+  }
+}
+
+/**
+ * Thread function for the benchmark workers.
+ */
+void *IpcBenchmark::threadFunction(void *arg) {
+  ThreadArgs *args = static_cast<ThreadArgs *>(arg);
+  try {
+    runWorker(*args->benchmarkCase, args->shared, args->iterations,
+              args->latencies);
+  } catch (const std::exception &e) {
+    fprintf(stderr, "Benchmark worker failed: %s\n", e.what());
+    exit(1);
+  }
+  return nullptr;
+}
+
+/**
+ * Measures the cost of a single timestamp, included in every sample.
+ *
+ * @return The mean overhead in nanoseconds.
+ */
+double IpcBenchmark::timerOverhead() {
+  const int samples = 100000;
+  uint64_t start = monotonicNs();
+  for (int i = 0; i < samples; i++) {
+    monotonicNs();
+  }
+  return (monotonicNs() - start) / static_cast<double>(samples);
+}
+
+/**
+ * Formats a benchmark result as a JSON object.
+ *
+ * @param result The result.
+ * @return The JSON object.
+ */
+std::string IpcBenchmark::toJson(const BenchmarkResult &result) {
+  char buffer[512];
+  snprintf(buffer, sizeof(buffer),
+           "{\"name\": \"%s\", \"mode\": \"%s\", \"workers\": %d, "
+           "\"iterations\": %d, \"wall_s\": %.6f, \"ns_per_op\": %.1f, "
+           "\"ops_per_s\": %.1f, \"p50_ns\": %.0f, \"p90_ns\": %.0f, "
+           "\"p99_ns\": %.0f, \"p999_ns\": %.0f, \"max_ns\": %.0f}",
+           result.name.c_str(), result.mode.c_str(), result.workers,
+           result.iterations, result.wallSeconds, result.nsPerOp,
+           result.opsPerSecond, result.p50, result.p90, result.p99,
+           result.p999, result.max);
+  return buffer;
+}
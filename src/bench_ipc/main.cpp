@@ -0,0 +1,62 @@
+#include "bench_ipc/IpcBenchmark.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+const char *usage = "Usage: ./bench_ipc [-w max workers] [-i iterations] "
+                    "[-f name filter] [-m process|thread|both]";
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  int maxWorkers = std::max(2L, sysconf(_SC_NPROCESSORS_ONLN));
+  int iterations = 100000;
+  std::string filter = "";
+  std::string mode = "both";
+
+  try {
+    int option;
+    while ((option = getopt(argc, argv, "w:i:f:m:")) != -1) {
+      switch (option) {
+      case 'w':
+        maxWorkers = std::stoi(optarg);
+        break;
+      case 'i':
+        iterations = std::stoi(optarg);
+        break;
+      case 'f':
+        filter = optarg;
+        break;
+      case 'm':
+        mode = optarg;
+        break;
+      default:
+        throw std::invalid_argument(usage);
+      }
+    }
+
+    if (optind != argc || maxWorkers <= 0 || iterations <= 0 ||
+        (mode != "process" && mode != "thread" && mode != "both")) {
+      throw std::invalid_argument(usage);
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "Failed to validate arguments: \n\t" << e.what() << std::endl;
+    return 1;
+  }
+
+  try {
+    IpcBenchmark benchmark(maxWorkers, iterations, filter, mode != "thread",
+                           mode != "process");
+    std::cout << benchmark.run();
+  } catch (const std::exception &e) {
+    std::cerr << "Benchmark failed: " << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -1,11 +1,16 @@
 #include "candidate/CandidateProcess.h"
 
 #include "common/ipc/MutexWrapper.h"
+#include "common/ipc/SemaphoreManager.h"
 #include "common/ipc/SharedMemoryManager.h"
 #include "common/output/Logger.h"
+#include "common/output/Tracer.h"
 #include "common/process/ProcessRegistry.h"
+#include "common/utils/Memory.h"
 #include "common/utils/Misc.h"
+#include "common/utils/Time.h"
 #include <signal.h>
+#include <sstream>
 
 /**
  * Constructor for the candidate process.
@@ -46,9 +51,9 @@ CandidateProcess::CandidateProcess(int argc, char *argv[])
 void CandidateProcess::validateArguments(int argc, char *argv[]) {
   /* Validate argument count */
   /* Candidate index */
-  /* + 5 times for commission A */
-  /* + 3 times for commission B */
-  if (argc != 10) {
+  /* + comma-separated times for commission A */
+  /* + comma-separated times for commission B */
+  if (argc != 4) {
     throw std::invalid_argument("Invalid number of arguments. Usage: "
                                 "./candidate <index> <timesA> <timesB>");
   }
@@ -66,37 +71,60 @@ void CandidateProcess::validateArguments(int argc, char *argv[]) {
   Logger::setProcessPrefix("Candidate (id=" + std::to_string(index) +
                            ", pid=" + std::to_string(pid_) + ")");
 
-  /* Validate times for commission A */
-  /* Expected format: double[] */
+  /* Validate times for commission A and B */
+  /* Expected format: double[,double...] */
   /* Expected value: t[i] > 0.0 */
-  for (int i = 0; i < 5; i++) {
-    timesA[i] = std::stod(argv[2 + i]);
-    if (timesA[i] <= 0.0) {
-      throw std::invalid_argument("Times A must be positive");
-    }
-  }
+  timesA = parseTimes(argv[2], "A");
+  timesB = parseTimes(argv[3], "B");
+}
 
-  /* Validate times for commission B */
-  /* Expected format: double[] */
-  /* Expected value: t[i] > 0.0 */
-  for (int i = 0; i < 3; i++) {
-    timesB[i] = std::stod(argv[7 + i]);
-    if (timesB[i] <= 0.0) {
-      throw std::invalid_argument("Times B must be positive");
+/**
+ * Parses a comma-separated list of answer times.
+ *
+ * @param list The list.
+ * @param name The name of the commission, used in errors.
+ * @return The answer times.
+ * @throws std::invalid_argument If a time is invalid.
+ */
+std::vector<double> CandidateProcess::parseTimes(const char *list,
+                                                 const char *name) {
+  std::vector<double> times;
+  std::stringstream ss(list);
+  std::string time;
+  while (std::getline(ss, time, ',')) {
+    times.push_back(std::stod(time));
+    if (times.back() <= 0.0) {
+      throw std::invalid_argument(std::string("Times ") + name +
+                                  " must be positive");
     }
   }
+  return times;
 }
 
 /**
  * Initializes the candidate process.
+ *
+ * @throw std::runtime_error If the answer times do not match the commissions.
  */
-void CandidateProcess::initialize() { SharedMemoryManager::attach(); }
+void CandidateProcess::initialize() {
+  SharedMemoryManager::attach();
+
+  /* One answer time per member, the member counts are chosen by the dean */
+  if (timesA.size() !=
+          (size_t)SharedMemoryManager::data()->commissionA[0].memberCount ||
+      timesB.size() !=
+          (size_t)SharedMemoryManager::data()->commissionB[0].memberCount) {
+    throw std::runtime_error("Answer times do not match the member counts");
+  }
+
+  Tracer::setProcessName("candidate " + std::to_string(index));
+  ProcessRegistry::markReady();
+}
 
 /**
  * Sets up the signal handlers for the candidate process.
  */
 void CandidateProcess::setupSignalHandlers() {
-  registerSignal(SIGUSR2, rejectionHandler);
   registerSignal(SIGTERM, terminationHandler);
 }
 
@@ -126,8 +154,8 @@ void CandidateProcess::handleError(const char *message) {
 }
 
 /**
- * Waits for the exam to start by checking the examStarted flag in the shared
- * memory.
+ * Waits for the exam to start, signalled by the dean through the examState
+ * condition variable.
  */
 void CandidateProcess::waitForExamStart() {
   try {
@@ -135,16 +163,12 @@ void CandidateProcess::waitForExamStart() {
     pthread_mutex_t *examStateMutex =
         &SharedMemoryManager::data()->examStateMutex;
 
-    while (true) {
-      MutexWrapper::lock(examStateMutex);
-      if (SharedMemoryManager::data()->examStarted) {
-        MutexWrapper::unlock(examStateMutex);
-        break;
-      }
-      MutexWrapper::unlock(examStateMutex);
-
-      Misc::safeSleep(1);
+    MutexWrapper::lock(examStateMutex);
+    while (!SharedMemoryManager::data()->examStarted) {
+      MutexWrapper::wait(&SharedMemoryManager::data()->examStateCond,
+                         examStateMutex);
     }
+    MutexWrapper::unlock(examStateMutex);
   } catch (const std::exception &e) {
     std::string errorMessage =
         "Failed to wait for exam start: " + std::string(e.what());
@@ -163,21 +187,32 @@ void CandidateProcess::getCommissionSeat(char commission) {
     seat = -1;
   }
 
+  CommissionMetrics &metrics =
+      SharedMemoryManager::data()->metrics.commissions[commission == 'A' ? 0
+                                                                         : 1];
+
   try {
-    sem_t *semaphore = SemaphoreManager::open(
-        (commission == 'A') ? "commissionA" : "commissionB");
+    timeline(commission).queuedAt = Time::monotonicNs();
+    metrics.queued++;
+    joinShard(commission);
 
+    /* The commission hands a freed seat to the head of the queue and posts
+     * only that candidate */
+    CandidateInfo *candidate = &SharedMemoryManager::data()->candidates[index];
     while (seat == -1) {
-      SemaphoreManager::wait(semaphore);
-      seat = findCommissionSeat(commission);
-
-      if (seat == -1) {
-        SemaphoreManager::post(semaphore);
-        Misc::safeUSleep(10000);
+      /* Shards spawned by the autoscaler after queueing take over waiters */
+      if (!SemaphoreManager::timedWait(&candidate->seatReady,
+                                       rebalanceIntervalMs)) {
+        moveShard(commission);
+        continue;
       }
+      seat = candidate->assignedSeat;
     }
 
-    SemaphoreManager::close(semaphore);
+    metrics.queued--;
+    timeline(commission).seatedAt = Time::monotonicNs();
+    recordLatency(commission, SeatWaitPhase, timeline(commission).queuedAt,
+                  timeline(commission).seatedAt);
   } catch (const std::exception &e) {
     std::string errorMessage =
         "Failed to get commission seat: " + std::string(e.what());
@@ -186,39 +221,137 @@ void CandidateProcess::getCommissionSeat(char commission) {
 }
 
 /**
- * Finds a seat for the given commission.
+ * Chooses the shard of the given commission, as configured by the dean.
+ * Only shards open to new candidates are considered.
  *
- * @param commission The commission to find a seat for.
- * @return The seat number, or -1 if no seat is found.
+ * @param commission The commission to choose a shard of.
+ * @return The shard.
  */
-int CandidateProcess::findCommissionSeat(char commission) {
-  pthread_mutex_t *comissionMutex = nullptr;
-  if (commission == 'A') {
-    comissionMutex = &SharedMemoryManager::data()->commissionAMutex;
-  } else {
-    comissionMutex = &SharedMemoryManager::data()->commissionBMutex;
+int CandidateProcess::chooseShard(char commission) {
+  SharedState *state = SharedMemoryManager::data();
+  int slotCount = commission == 'A' ? state->commissionAShardCount
+                                    : state->commissionBShardCount;
+
+  std::vector<int> open;
+  for (int i = 0; i < slotCount; i++) {
+    if (Memory::commission(commission, i)->open()) {
+      open.push_back(i);
+    }
   }
 
-  try {
-    MutexWrapper::lock(comissionMutex);
-    CommissionInfo *commissionInfo =
-        commission == 'A' ? &SharedMemoryManager::data()->commissionA
-                          : &SharedMemoryManager::data()->commissionB;
-
-    for (int i = 0; i < 3; i++) {
-      if (commissionInfo->seats[i].pid == -1) {
-        commissionInfo->seats[i] = {
-            .pid = getpid(), .questionsCount = 0, .answered = false};
-        MutexWrapper::unlock(comissionMutex);
-        return i;
+  /* Base shards stay open while any candidate of the type is ungraded */
+  if (open.empty()) {
+    return 0;
+  }
+
+  int first = index % open.size();
+  if (state->shardAssignment == IndexHashAssignment) {
+    return open[first];
+  }
+
+  /* Least loaded, ties broken from the hashed shard to spread candidates */
+  int chosen = open[first];
+  for (size_t i = 1; i < open.size(); i++) {
+    int candidate = open[(first + i) % open.size()];
+    if (Memory::commission(commission, candidate)->load <
+        Memory::commission(commission, chosen)->load) {
+      chosen = candidate;
+    }
+  }
+  return chosen;
+}
+
+/**
+ * Joins the queue of a shard of the given commission, or takes a free seat
+ * directly when nobody is waiting for the shard.
+ *
+ * @param commission The commission to join.
+ */
+void CandidateProcess::joinShard(char commission) {
+  CandidateInfo *candidate = &SharedMemoryManager::data()->candidates[index];
+
+  /* The shard may retire between choosing and queueing, so queue under its
+   * mutex and choose again if it no longer takes candidates */
+  for (bool joined = false; !joined;) {
+    shard = chooseShard(commission);
+    pthread_mutex_t *shardMutex = Memory::commissionMutex(commission, shard);
+    MutexWrapper::lock(shardMutex);
+    CommissionInfo *info = Memory::commission(commission, shard);
+    joined = info->open();
+    if (joined) {
+      info->load++;
+      candidate->assignedSeat = -1;
+      if (info->queueHead == -1) {
+        seat = findCommissionSeat(commission);
+      }
+      if (seat == -1) {
+        Memory::enqueue(commission, shard, index);
       }
     }
+    MutexWrapper::unlock(shardMutex);
+  }
+}
 
-    MutexWrapper::unlock(comissionMutex);
-  } catch (const std::exception &e) {
-    std::string errorMessage =
-        "Failed to find commission seat: " + std::string(e.what());
-    handleError(errorMessage.c_str());
+/**
+ * Moves a waiting candidate to a shard with a shorter queue, or away from a
+ * shard that is retiring.
+ *
+ * @param commission The commission the candidate waits for.
+ * @return True if the candidate has moved, false otherwise.
+ */
+bool CandidateProcess::moveShard(char commission) {
+  CommissionInfo *current = Memory::commission(commission, shard);
+  int chosen = chooseShard(commission);
+  if (chosen == shard) {
+    return false;
+  }
+
+  CommissionInfo *target = Memory::commission(commission, chosen);
+  if (current->open() && target->load + 1 >= current->load) {
+    return false;
+  }
+
+  /* The seat may have been handed over since the wait timed out, the next
+   * wait then returns at once */
+  CandidateInfo *candidate = &SharedMemoryManager::data()->candidates[index];
+  pthread_mutex_t *shardMutex = Memory::commissionMutex(commission, shard);
+  MutexWrapper::lock(shardMutex);
+  bool waiting = candidate->assignedSeat == -1;
+  if (waiting) {
+    Memory::dequeue(commission, shard, index);
+    current->load--;
+  }
+  MutexWrapper::unlock(shardMutex);
+
+  if (waiting) {
+    joinShard(commission);
+  }
+
+  return waiting;
+}
+
+/**
+ * Finds a free seat of the shard and takes it. Must be called with the shard
+ * mutex held.
+ *
+ * @param commission The commission to find a seat for.
+ * @return The seat number, or -1 if no seat is found.
+ */
+int CandidateProcess::findCommissionSeat(char commission) {
+  CommissionInfo *commissionInfo = Memory::commission(commission, shard);
+
+  for (int i = 0; i < commissionInfo->seatCount; i++) {
+    if (commissionInfo->seat(i).pid == -1) {
+      CommissionSeat &seat = commissionInfo->seat(i);
+      seat.pid = getpid();
+      seat.questionsCount = 0;
+      seat.answered = false;
+      Memory::enqueueQuestions(commission, shard, i);
+      SharedMemoryManager::data()
+          ->metrics.commissions[commission == 'A' ? 0 : 1]
+          .seatsBusy++;
+      return i;
+    }
   }
 
   return -1;
@@ -229,26 +362,19 @@ int CandidateProcess::findCommissionSeat(char commission) {
  * the shared memory.
  */
 void CandidateProcess::waitForQuestions(char commission) {
-  pthread_mutex_t *comissionMutex = nullptr;
-  if (commission == 'A') {
-    comissionMutex = &SharedMemoryManager::data()->commissionAMutex;
-  } else {
-    comissionMutex = &SharedMemoryManager::data()->commissionBMutex;
-  }
+  pthread_mutex_t *comissionMutex = Memory::commissionMutex(commission, shard);
 
   try {
     Logger::info("CandidateProcess::waitForQuestions()");
     Logger::info("Candidate process with pid " + std::to_string(getpid()) +
                  " waiting for questions from commission " + commission);
 
+    CommissionInfo *commissionInfo = Memory::commission(commission, shard);
+
     while (true) {
       MutexWrapper::lock(comissionMutex);
-      if ((commission == 'A' && SharedMemoryManager::data()
-                                        ->commissionA.seats[seat]
-                                        .questionsCount == (1 << 5) - 1) ||
-          (commission == 'B' && SharedMemoryManager::data()
-                                        ->commissionB.seats[seat]
-                                        .questionsCount == (1 << 3) - 1)) {
+      if (commissionInfo->seat(seat).questionsCount ==
+          commissionInfo->fullMask) {
         MutexWrapper::unlock(comissionMutex);
         break;
       }
@@ -256,6 +382,10 @@ void CandidateProcess::waitForQuestions(char commission) {
 
       Misc::safeSleep(1);
     }
+
+    timeline(commission).questionsAt = Time::monotonicNs();
+    recordLatency(commission, QuestionWaitPhase, timeline(commission).seatedAt,
+                  timeline(commission).questionsAt);
   } catch (const std::exception &e) {
     std::string errorMessage =
         "Failed to wait for questions: " + std::string(e.what());
@@ -268,33 +398,23 @@ void CandidateProcess::waitForQuestions(char commission) {
  */
 void CandidateProcess::prepareAnswers(char commission) {
   double sleepTime = 0.0;
-  if (commission == 'A') {
-    for (int i = 0; i < 5; i++) {
-      sleepTime += timesA[i];
-    }
-  } else {
-    for (int i = 0; i < 3; i++) {
-      sleepTime += timesB[i];
-    }
+  for (double time : commission == 'A' ? timesA : timesB) {
+    sleepTime += time;
   }
 
   try {
     Misc::safeUSleep(sleepTime * 1000000);
 
-    pthread_mutex_t *comissionMutex = nullptr;
-    if (commission == 'A') {
-      comissionMutex = &SharedMemoryManager::data()->commissionAMutex;
-    } else {
-      comissionMutex = &SharedMemoryManager::data()->commissionBMutex;
-    }
+    pthread_mutex_t *comissionMutex =
+        Memory::commissionMutex(commission, shard);
 
     MutexWrapper::lock(comissionMutex);
-    if (commission == 'A') {
-      SharedMemoryManager::data()->commissionA.seats[seat].answered = true;
-    } else {
-      SharedMemoryManager::data()->commissionB.seats[seat].answered = true;
-    }
+    Memory::commission(commission, shard)->seat(seat).answered = true;
     MutexWrapper::unlock(comissionMutex);
+
+    timeline(commission).answeredAt = Time::monotonicNs();
+    recordLatency(commission, AnsweringPhase, timeline(commission).questionsAt,
+                  timeline(commission).answeredAt);
   } catch (const std::exception &e) {
     std::string errorMessage =
         "Failed to sleep in prepareAnswers: " + std::string(e.what());
@@ -305,34 +425,110 @@ void CandidateProcess::prepareAnswers(char commission) {
                " answered questions");
 }
 
+/**
+ * Answers the questions of the given commission, either after all of them
+ * have arrived or, in the pipelined mode chosen by the dean, each one as soon
+ * as its member has asked it.
+ *
+ * @param commission The commission asking the questions.
+ */
+void CandidateProcess::answerQuestions(char commission) {
+  if (SharedMemoryManager::data()->pipelinedAnswers) {
+    answerPipelined(commission);
+  } else {
+    waitForQuestions(commission);
+    prepareAnswers(commission);
+  }
+}
+
+/**
+ * Answers each question as soon as it arrives, so that the questions of the
+ * slower members are generated while the earlier ones are being answered.
+ *
+ * @param commission The commission asking the questions.
+ */
+void CandidateProcess::answerPipelined(char commission) {
+  pthread_mutex_t *comissionMutex = Memory::commissionMutex(commission, shard);
+  CommissionInfo *commissionInfo = Memory::commission(commission, shard);
+  const std::vector<double> &times = commission == 'A' ? timesA : timesB;
+
+  try {
+    Logger::info("Candidate process with pid " + std::to_string(getpid()) +
+                 " answering questions from commission " + commission +
+                 " as they arrive");
+
+    int answered = 0;
+    while (answered != commissionInfo->fullMask) {
+      MutexWrapper::lock(comissionMutex);
+      int asked = commissionInfo->seat(seat).questionsCount;
+      MutexWrapper::unlock(comissionMutex);
+
+      if (asked == commissionInfo->fullMask &&
+          timeline(commission).questionsAt == 0) {
+        timeline(commission).questionsAt = Time::monotonicNs();
+        recordLatency(commission, QuestionWaitPhase,
+                      timeline(commission).seatedAt,
+                      timeline(commission).questionsAt);
+      }
+
+      int pending = asked & ~answered;
+      if (pending == 0) {
+        Misc::safeUSleep(questionPollMs * 1000);
+        continue;
+      }
+
+      /* Questions that arrived together are answered in member order */
+      double sleepTime = 0.0;
+      for (size_t member = 0; member < times.size(); member++) {
+        if (pending & (1 << member)) {
+          sleepTime += times[member];
+        }
+      }
+      Misc::safeUSleep(sleepTime * 1000000);
+      answered |= pending;
+    }
+
+    MutexWrapper::lock(comissionMutex);
+    commissionInfo->seat(seat).answered = true;
+    MutexWrapper::unlock(comissionMutex);
+
+    timeline(commission).answeredAt = Time::monotonicNs();
+    recordLatency(commission, AnsweringPhase, timeline(commission).questionsAt,
+                  timeline(commission).answeredAt);
+  } catch (const std::exception &e) {
+    std::string errorMessage =
+        "Failed to answer questions: " + std::string(e.what());
+    handleError(errorMessage.c_str());
+  }
+
+  Logger::info("Candidate process with pid " + std::to_string(getpid()) +
+               " answered questions");
+}
+
 /**
  * Waits for the grading to be available by checking the theoreticalScore or
- * practicalScore in the shared memory.
+ * practicalScore in the shared memory, without taking the candidate mutex.
  */
 void CandidateProcess::waitForGrading(char commission) {
-  pthread_mutex_t *candidatesMutex =
-      &SharedMemoryManager::data()->candidateMutex;
+  const CandidateInfo *candidate =
+      &SharedMemoryManager::data()->candidates[index];
 
   try {
     while (true) {
-      MutexWrapper::lock(candidatesMutex);
-      if (commission == 'A') {
-        if (SharedMemoryManager::data()->candidates[index].theoreticalScore >=
-            0) {
-          MutexWrapper::unlock(candidatesMutex);
-          break;
-        }
-      } else {
-        if (SharedMemoryManager::data()->candidates[index].practicalScore >=
-            0) {
-          MutexWrapper::unlock(candidatesMutex);
-          break;
-        }
+      CandidateScores scores = Memory::readScores(candidate);
+      double score = commission == 'A' ? scores.theoreticalScore
+                                       : scores.practicalScore;
+      if (score >= 0) {
+        break;
       }
-      MutexWrapper::unlock(candidatesMutex);
 
       Misc::safeSleep(1);
     }
+
+    timeline(commission).gradedAt = Time::monotonicNs();
+    recordLatency(commission, GradingWaitPhase,
+                  timeline(commission).answeredAt,
+                  timeline(commission).gradedAt);
   } catch (const std::exception &e) {
     std::string errorMessage =
         "Failed to wait for grading: " + std::string(e.what());
@@ -344,19 +540,15 @@ void CandidateProcess::waitForGrading(char commission) {
  * Exits the exam if the candidate failed the commission A.
  */
 void CandidateProcess::maybeExitExam() {
-  pthread_mutex_t *candidatesMutex =
-      &SharedMemoryManager::data()->candidateMutex;
+  CandidateScores scores =
+      Memory::readScores(&SharedMemoryManager::data()->candidates[index]);
 
-  MutexWrapper::lock(candidatesMutex);
-  if (SharedMemoryManager::data()->candidates[index].theoreticalScore < 30) {
-    MutexWrapper::unlock(candidatesMutex);
+  if (scores.theoreticalScore < 30) {
     Logger::info("Candidate process with pid " + std::to_string(getpid()) +
                  " failed to pass the exam");
     cleanup();
     exit(0);
   }
-
-  MutexWrapper::unlock(candidatesMutex);
 }
 
 /**
@@ -365,6 +557,9 @@ void CandidateProcess::maybeExitExam() {
 void CandidateProcess::cleanup() {
   Logger::info("CandidateProcess::cleanup()");
 
+  /* Unregister while the shared memory is still attached */
+  ProcessRegistry::unregister(getpid());
+
   try {
     SharedMemoryManager::detach();
   } catch (const std::exception &e) {
@@ -375,25 +570,6 @@ void CandidateProcess::cleanup() {
 
   Logger::info("Candidate process with pid " + std::to_string(getpid()) +
                " exiting with status 0");
-  ProcessRegistry::unregister(getpid());
-}
-
-/**
- * Handles the rejection signal by cleaning up the candidate process.
- *
- * @param signal The signal that caused the rejection.
- */
-void CandidateProcess::rejectionHandler(int signal) {
-  Logger::info("CandidateProcess::rejectionHandler()");
-  Logger::info("Candidate process with pid " + std::to_string(getpid()) +
-               " exiting with status 0");
-
-  if (instance_) {
-    static_cast<CandidateProcess *>(instance_)->cleanup();
-    instance_ = nullptr;
-  }
-
-  exit(0);
 }
 
 /**
@@ -420,21 +596,43 @@ void CandidateProcess::terminationHandler(int signal) {
  * @return true if candidate is retaking the exam, false otherwise
  */
 bool CandidateProcess::isRetaking() {
-  pthread_mutex_t *candidatesMutex =
-      &SharedMemoryManager::data()->candidateMutex;
+  CandidateScores scores =
+      Memory::readScores(&SharedMemoryManager::data()->candidates[index]);
 
-  try {
-    MutexWrapper::lock(candidatesMutex);
-    if (SharedMemoryManager::data()->candidates[index].theoreticalScore >= 0) {
-      MutexWrapper::unlock(candidatesMutex);
-      return true;
-    }
+  return scores.theoreticalScore >= 0;
+}
 
-    MutexWrapper::unlock(candidatesMutex);
-    return false;
-  } catch (const std::exception &e) {
-    std::string errorMessage =
-        "Failed to validate retaking status: " + std::string(e.what());
-    handleError(errorMessage.c_str());
-  }
+/**
+ * Gets the timeline of the candidate in the given commission. The timeline is
+ * only written by the candidate itself, so no lock is needed.
+ *
+ * @param commission The commission.
+ * @return The timeline.
+ */
+PhaseTimeline &CandidateProcess::timeline(char commission) {
+  return SharedMemoryManager::data()
+      ->candidates[index]
+      .timeline.commissions[commission == 'A' ? 0 : 1];
+}
+
+/**
+ * Records the duration of a phase in the shared latency histograms and in the
+ * trace.
+ *
+ * @param commission The commission.
+ * @param phase The phase.
+ * @param from The start of the phase (monotonic ns).
+ * @param to The end of the phase (monotonic ns).
+ */
+void CandidateProcess::recordLatency(char commission, LatencyPhase phase,
+                                     uint64_t from, uint64_t to) {
+  SharedMemoryManager::data()
+      ->latency[commission == 'A' ? 0 : 1][phase]
+      .record((to - from) / 1000);
+
+  const char *phaseNames[2][LatencyPhaseCount] = {
+      {"A: seat wait", "A: question wait", "A: answering", "A: grading wait"},
+      {"B: seat wait", "B: question wait", "B: answering", "B: grading wait"}};
+  Tracer::complete("candidate", phaseNames[commission == 'A' ? 0 : 1][phase],
+                   from, to, index);
 }
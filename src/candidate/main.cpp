@@ -12,8 +12,7 @@ int main(int argc, char *argv[]) {
 
   if (!candidateProcess.isRetaking()) {
     candidateProcess.getCommissionSeat('A');
-    candidateProcess.waitForQuestions('A');
-    candidateProcess.prepareAnswers('A');
+    candidateProcess.answerQuestions('A');
     candidateProcess.waitForGrading('A');
     candidateProcess.maybeExitExam();
   } else {
@@ -21,8 +20,7 @@ int main(int argc, char *argv[]) {
   }
 
   candidateProcess.getCommissionSeat('B');
-  candidateProcess.waitForQuestions('B');
-  candidateProcess.prepareAnswers('B');
+  candidateProcess.answerQuestions('B');
   candidateProcess.waitForGrading('B');
 
   candidateProcess.cleanup();
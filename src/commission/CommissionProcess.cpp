@@ -3,11 +3,17 @@
 #include "common/ipc/MutexWrapper.h"
 #include "common/ipc/SharedMemoryManager.h"
 #include "common/output/Logger.h"
+#include "common/output/Tracer.h"
+#include "common/process/ProcessRegistry.h"
 #include "common/utils/Memory.h"
 #include "common/utils/Misc.h"
 #include "common/utils/Random.h"
+#include "common/utils/Time.h"
+#include <algorithm>
+#include <cstdint>
 #include <cstring>
 #include <errno.h>
+#include <stdexcept>
 #include <signal.h>
 #include <unistd.h>
 
@@ -17,8 +23,9 @@
  * @param argc The number of arguments passed to the program.
  * @param argv The arguments passed to the program.
  */
-CommissionProcess::CommissionProcess(int argc, char *argv[])
-    : BaseProcess(argc, argv, false), memberCount_(argc) {
+template <typename Traits>
+CommissionProcess<Traits>::CommissionProcess(int argc, char *argv[])
+    : BaseProcess(argc, argv, false) {
   try {
     validateArguments(argc, argv);
   } catch (const std::exception &e) {
@@ -47,54 +54,71 @@ CommissionProcess::CommissionProcess(int argc, char *argv[])
  * @param argv The arguments passed to the program.
  * @throws std::invalid_argument If the arguments are invalid.
  */
-void CommissionProcess::validateArguments(int argc, char *argv[]) {
-  if (argc != 2) {
+template <typename Traits>
+void CommissionProcess<Traits>::validateArguments(int argc, char *argv[]) {
+  if (argc != 2 && argc != 3) {
     throw std::invalid_argument("Invalid number of arguments. Usage: "
-                                "./commission <type>");
+                                "./commission <type> [shard]");
   }
 
-  commissionType_ = argv[1][0];
-  if (commissionType_ != 'A' && commissionType_ != 'B') {
+  if (argv[1][0] != Traits::type) {
     throw std::invalid_argument(
         "Invalid commission type. Usage: ./commission <type: A or B>");
   }
-  /* Set up logger prefix */
-  Logger::setProcessPrefix(
-      "Commission (type=" + std::string(1, commissionType_) +
-      ", pid=" + std::to_string(pid_) + ")");
-
-  if (commissionType_ == 'A') {
-    memberCount_ = 5;
-  } else if (commissionType_ == 'B') {
-    memberCount_ = 3;
+
+  /* Validate shard */
+  /* Expected value: 0 <= n < maxCommissionShards */
+  if (argc == 3) {
+    shard_ = std::stoi(argv[2]);
+    if (shard_ < 0 || shard_ >= maxCommissionShards) {
+      throw std::invalid_argument("Invalid commission shard");
+    }
   }
+
+  /* Set up logger prefix */
+  Logger::setProcessPrefix("Commission (type=" +
+                           std::string(1, Traits::type) +
+                           ", shard=" + std::to_string(shard_) +
+                           ", pid=" + std::to_string(pid_) + ")");
 }
 
 /**
  * Initializes the commission process.
  */
-void CommissionProcess::initialize() {
+template <typename Traits>
+void CommissionProcess<Traits>::initialize() {
   SharedMemoryManager::attach();
+  Tracer::setProcessName(std::string("commission ") + Traits::type +
+                         std::to_string(shard_));
 
-  try {
-    semaphore =
-        SemaphoreManager::open(std::string("commission") + commissionType_);
-  } catch (const std::exception &e) {
-    std::string errorMessage =
-        "Failed to open semaphore: " + std::string(e.what());
-    handleError(errorMessage.c_str());
-    exit(1);
+  if (SharedMemoryManager::data()->seeded) {
+    Random::seed(SharedMemoryManager::data()->randomSeed + Traits::type +
+                 shard_ * 1000);
+  }
+
+  if (shard_ >= Traits::shardCount(SharedMemoryManager::data())) {
+    throw std::runtime_error("Commission shard out of range");
   }
 
-  Logger::info(std::string("Initializing comission: ") + commissionType_ +
-               " with " + std::to_string(memberCount_) + " members");
+  CommissionInfo &info = Traits::info(SharedMemoryManager::data(), shard_);
+  threadIds.resize(info.memberCount);
+  /* The slot may have been used by an earlier, retired shard process */
+  Traits::processedCount(SharedMemoryManager::data(), shard_)
+      .store(0, std::memory_order_relaxed);
+  threadData.resize(info.memberCount);
+
+  Logger::info(std::string("Initializing comission: ") + Traits::type +
+               " with " + std::to_string(info.memberCount) + " members and " +
+               std::to_string(info.seatCount) + " seats");
+  ProcessRegistry::markReady();
 }
 
 /**
  * Sets up the signal handlers for the commission process.
  */
-void CommissionProcess::setupSignalHandlers() {
-  registerSignal(SIGTERM, CommissionProcess::terminationHandler);
+template <typename Traits>
+void CommissionProcess<Traits>::setupSignalHandlers() {
+  registerSignal(SIGTERM, CommissionProcess<Traits>::terminationHandler);
 }
 
 /**
@@ -103,7 +127,8 @@ void CommissionProcess::setupSignalHandlers() {
  *
  * @param message The message to display.
  */
-void CommissionProcess::handleError(const char *message) {
+template <typename Traits>
+void CommissionProcess<Traits>::handleError(const char *message) {
   /* Include both: the passed message and the errno message */
   if (message != nullptr) {
     perror(message);
@@ -123,26 +148,23 @@ void CommissionProcess::handleError(const char *message) {
 }
 
 /**
- * Waits for the exam to start by checking the examStarted flag in the shared
- * memory.
+ * Waits for the exam to start, signalled by the dean through the examState
+ * condition variable.
  */
-void CommissionProcess::waitForExamStart() {
+template <typename Traits>
+void CommissionProcess<Traits>::waitForExamStart() {
   pthread_mutex_t *examStateMutex =
       &SharedMemoryManager::data()->examStateMutex;
 
   try {
-    Logger::info("Commission " + std::string(1, commissionType_) +
+    Logger::info("Commission " + std::string(1, Traits::type) +
                  " waiting for exam start");
-    while (true) {
-      MutexWrapper::lock(examStateMutex);
-      if (SharedMemoryManager::data()->examStarted) {
-        MutexWrapper::unlock(examStateMutex);
-        break;
-      }
-      MutexWrapper::unlock(examStateMutex);
-
-      Misc::safeUSleep(500000);
+    MutexWrapper::lock(examStateMutex);
+    while (!SharedMemoryManager::data()->examStarted) {
+      MutexWrapper::wait(&SharedMemoryManager::data()->examStateCond,
+                         examStateMutex);
     }
+    MutexWrapper::unlock(examStateMutex);
   } catch (const std::exception &e) {
     std::string errorMessage =
         "Failed to wait for exam start: " + std::string(e.what());
@@ -153,72 +175,50 @@ void CommissionProcess::waitForExamStart() {
 /**
  * Starts the commission process.
  */
-void CommissionProcess::start() {
+template <typename Traits>
+void CommissionProcess<Traits>::start() {
   Logger::info("CommissionProcess::start()");
   spawnThreads();
 
-  Logger::info("Commission " + std::string(1, commissionType_) +
-               " releasing 3 seats after exam start");
-  for (int i = 0; i < 3; i++) {
-    try {
-      SemaphoreManager::post(semaphore);
-    } catch (const std::exception &e) {
-      std::string errorMessage =
-          "Failed to post to semaphore: " + std::string(e.what());
-      handleError(errorMessage.c_str());
+  pthread_mutex_t *commissionMutex =
+      Traits::mutex(SharedMemoryManager::data(), shard_);
+  CommissionInfo &info = Traits::info(SharedMemoryManager::data(), shard_);
+  Logger::info("Commission " + std::string(1, Traits::type) + " handing " +
+               std::to_string(info.seatCount) +
+               " seats to the queue after exam start");
+
+  /* Candidates queued before the commission started, the others take free
+   * seats directly */
+  try {
+    MutexWrapper::lock(commissionMutex);
+    for (int i = 0; i < info.seatCount; i++) {
+      if (info.seat(i).pid == -1) {
+        Memory::handOffSeat(Traits::type, shard_, i);
+      }
     }
+    MutexWrapper::unlock(commissionMutex);
+  } catch (const std::exception &e) {
+    std::string errorMessage =
+        "Failed to hand off seats: " + std::string(e.what());
+    handleError(errorMessage.c_str());
   }
 
   mainLoop();
 }
 
-/**
- * Gets the commission info for the given commission type.
- *
- * @return The commission info.
- */
-CommissionInfo *CommissionProcess::commission() {
-  return commissionType_ == 'A' ? &SharedMemoryManager::data()->commissionA
-                                : &SharedMemoryManager::data()->commissionB;
-}
-
-/**
- * Gets the total number of candidates for the given commission type.
- *
- * @return The total number of candidates.
- */
-int CommissionProcess::totalCandidates() {
-  return commissionType_ == 'A'
-             ? SharedMemoryManager::data()->commissionACandidateCount
-             : SharedMemoryManager::data()->commissionBCandidateCount;
-}
-
 /**
  * Main loop for the commission process.
  */
-void CommissionProcess::mainLoop() {
-  pthread_mutex_t *commissionMutex = nullptr;
-  if (commissionType_ == 'A') {
-    commissionMutex = &SharedMemoryManager::data()->commissionAMutex;
-  } else {
-    commissionMutex = &SharedMemoryManager::data()->commissionBMutex;
-  }
-
+template <typename Traits>
+void CommissionProcess<Traits>::mainLoop() {
   try {
     while (running) {
       /* Check if all candidates have been graded and commission is empty */
       maybeFinish();
+      maybeRetire();
 
-      /* Grade one candidate if they have answered the questions */
-      for (int i = 0; i < 3; i++) {
-        if (maybeGradeCandidate(i)) {
-          MutexWrapper::lock(commissionMutex);
-          Memory::resetSeat(commissionType_, i);
-          MutexWrapper::unlock(commissionMutex);
-          SemaphoreManager::post(semaphore);
-          break;
-        }
-      }
+      /* Grade everyone who has answered the questions */
+      gradeAnsweredSeats();
 
       /* Wait for next commission iteration*/
       Misc::safeUSleep(1000000);
@@ -233,19 +233,17 @@ void CommissionProcess::mainLoop() {
 /**
  * Spawns the threads for the commission members.
  */
-void CommissionProcess::spawnThreads() {
+template <typename Traits>
+void CommissionProcess<Traits>::spawnThreads() {
   Logger::info("CommissionProcess::spawnThreads()");
 
-  pthread_mutex_t *commissionMutex = nullptr;
-  if (commissionType_ == 'A') {
-    commissionMutex = &SharedMemoryManager::data()->commissionAMutex;
-  } else {
-    commissionMutex = &SharedMemoryManager::data()->commissionBMutex;
-  }
+  pthread_mutex_t *commissionMutex =
+      Traits::mutex(SharedMemoryManager::data(), shard_);
 
-  for (int i = 0; i < memberCount_; i++) {
+  for (size_t i = 0; i < threadIds.size(); i++) {
     threadData[i].memberId = i;
-    threadData[i].commissionId = commissionType_;
+    threadData[i].commissionId = Traits::type;
+    threadData[i].shard = shard_;
     threadData[i].running = &running;
     threadData[i].mutex = commissionMutex;
     int result =
@@ -260,57 +258,129 @@ void CommissionProcess::spawnThreads() {
 /**
  * Waits for the threads to finish execution.
  */
-void CommissionProcess::waitThreads() {
+template <typename Traits>
+void CommissionProcess<Traits>::waitThreads() {
   Logger::info("CommissionProcess::waitThreads()");
-  for (int i = 0; i < memberCount_; i++) {
+  for (size_t i = 0; i < threadIds.size(); i++) {
     pthread_join(threadIds[i], nullptr);
   }
 }
 
 /**
- * Thread function for the commission members.
+ * Thread function for the commission members. A member blocks until a seat is
+ * taken, then asks its question after a think time of a few seconds. Questions
+ * for several seats are thought about at the same time.
  */
-void *CommissionProcess::threadFunction(void *arg) {
+template <typename Traits>
+void *CommissionProcess<Traits>::threadFunction(void *arg) {
   ThreadData *data = static_cast<ThreadData *>(arg);
 
   Logger::info("Commission " + std::string(1, data->commissionId) + " member " +
                std::to_string(data->memberId) + " started");
 
   int memberBit = 1 << data->memberId;
+  Tracer::setThreadName("member " + std::to_string(data->memberId));
 
-  while (*data->running) {
-    int delay = Random::randomInt(2, 5);
-    try {
-      Misc::safeSleep(delay);
-    } catch (const std::exception &e) {
-      std::string errorMessage =
-          "Failed to sleep in threadFunction: " + std::string(e.what());
-      static_cast<CommissionProcess *>(instance_)->handleError(
-          errorMessage.c_str());
-    }
+  if (SharedMemoryManager::data()->seeded) {
+    Random::seed(SharedMemoryManager::data()->randomSeed +
+                 data->commissionId * 31 + data->shard * 1000 +
+                 data->memberId + 1);
+  }
 
-    if (!*data->running)
-      break;
+  CommissionInfo *commission =
+      &Traits::info(SharedMemoryManager::data(), data->shard);
+
+  /* Questions being thought about: the seat, its candidate at the time the
+   * task was taken and when the question is ready */
+  struct Question {
+    int seat;
+    int pid;
+    uint64_t takenAt;
+    uint64_t readyAt;
+  };
+  std::vector<Question> thinking;
+  /* Questions asked under the shard mutex, logged after releasing it */
+  std::vector<Question> asked;
 
+  try {
     MutexWrapper::lock(data->mutex);
-    SharedState *state = SharedMemoryManager::data();
-    CommissionInfo *commission =
-        (data->commissionId == 'A') ? &state->commissionA : &state->commissionB;
+    /* A cancelled wait returns with the mutex held */
+    pthread_cleanup_push(
+        [](void *mutex) {
+          pthread_mutex_unlock(static_cast<pthread_mutex_t *>(mutex));
+        },
+        data->mutex);
+
+    while (*data->running) {
+      uint64_t now = Time::monotonicNs();
+
+      for (int seat = Memory::takeQuestion(Traits::type, data->shard,
+                                           data->memberId);
+           seat != -1; seat = Memory::takeQuestion(Traits::type, data->shard,
+                                                   data->memberId)) {
+        if (commission->seat(seat).pid != -1) {
+          uint64_t think = Random::randomInt(2, 5) * 1000000000ULL;
+          thinking.push_back({seat, commission->seat(seat).pid, now,
+                              now + think});
+        }
+      }
 
-    for (int seat = 0; seat < 3; ++seat) {
-      if (commission->seats[seat].pid != -1 &&
-          !(commission->seats[seat].questionsCount & memberBit)) {
-        commission->seats[seat].questionsCount |= memberBit;
+      uint64_t nextReady = UINT64_MAX;
+      for (size_t i = 0; i < thinking.size();) {
+        Question question = thinking[i];
+        if (question.readyAt > now) {
+          nextReady = std::min(nextReady, question.readyAt);
+          i++;
+          continue;
+        }
 
-        int pid = commission->seats[seat].pid;
+        /* The candidate may have left during the think time */
+        CommissionSeat &seat = commission->seat(question.seat);
+        if (seat.pid == question.pid && !(seat.questionsCount & memberBit)) {
+          seat.questionsCount |= memberBit;
+          question.readyAt = now;
+          asked.push_back(question);
+        }
+        thinking[i] = thinking.back();
+        thinking.pop_back();
+      }
 
-        Logger::info("Member " + std::to_string(data->memberId) +
-                     " generated question for seat " + std::to_string(seat) +
-                     " taken by pid " + std::to_string(pid));
+      /* The logger may wait on its semaphore and the file, which must not
+       * hold up the other members and the candidates of the shard. Tasks
+       * queued meanwhile are taken before waiting again */
+      if (!asked.empty()) {
+        int cancelState;
+        pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &cancelState);
+        MutexWrapper::unlock(data->mutex);
+        for (const Question &question : asked) {
+          Logger::info("Member " + std::to_string(data->memberId) +
+                       " generated question for seat " +
+                       std::to_string(question.seat) + " taken by pid " +
+                       std::to_string(question.pid));
+          Tracer::complete("commission", "generate question", question.takenAt,
+                           question.readyAt, question.seat);
+        }
+        asked.clear();
+        MutexWrapper::lock(data->mutex);
+        pthread_setcancelstate(cancelState, nullptr);
+        continue;
       }
+
+      /* Idle members wake up only to notice the end of the exam */
+      int timeoutMs =
+          nextReady == UINT64_MAX
+              ? idleWaitMs
+              : static_cast<int>((nextReady - now) / 1000000) + 1;
+      MutexWrapper::wait(&commission->tasksReady, data->mutex, timeoutMs);
     }
 
+    pthread_cleanup_pop(0);
     MutexWrapper::unlock(data->mutex);
+  } catch (const std::exception &e) {
+    std::string errorMessage =
+        "Failed in member thread: " + std::string(e.what());
+    static_cast<CommissionProcess<Traits> *>(instance_)->handleError(
+        errorMessage.c_str());
   }
 
   Logger::info("Member " + std::to_string(data->memberId) + " finished work");
@@ -321,13 +391,18 @@ void *CommissionProcess::threadFunction(void *arg) {
 /**
  * Cleans up the commission process.
  */
-void CommissionProcess::cleanup() {
+template <typename Traits>
+void CommissionProcess<Traits>::cleanup() {
   Logger::info("CommissionProcess::cleanup()");
+
+  /* Wake the members blocked on the task queue */
+  running = false;
+  pthread_cond_broadcast(
+      &Traits::info(SharedMemoryManager::data(), shard_).tasksReady);
   waitThreads();
 
   try {
     SharedMemoryManager::detach();
-    SemaphoreManager::close(semaphore);
   } catch (const std::exception &e) {
     std::string errorMessage =
         "Failed to cleanup the commission process: " + std::string(e.what());
@@ -340,16 +415,18 @@ void CommissionProcess::cleanup() {
 /**
  * Handles the termination signal for the commission process.
  */
-void CommissionProcess::terminationHandler(int signal) {
+template <typename Traits>
+void CommissionProcess<Traits>::terminationHandler(int signal) {
   Logger::info("CommissionProcess::terminationHandler()");
   Logger::info("Termination signal: SIG " + std::to_string(signal) +
                " received");
 
   if (instance_) {
-    auto commissionProcess = static_cast<CommissionProcess *>(instance_);
+    auto commissionProcess =
+        static_cast<CommissionProcess<Traits> *>(instance_);
     commissionProcess->running = false;
 
-    for (int i = 0; i < commissionProcess->memberCount_; i++) {
+    for (size_t i = 0; i < commissionProcess->threadIds.size(); i++) {
       int result = pthread_cancel(commissionProcess->threadIds[i]);
       if (result != 0 && result != ESRCH) {
         Logger::warn("Failed to cancel thread " + std::to_string(i) + ": " +
@@ -366,146 +443,273 @@ void CommissionProcess::terminationHandler(int signal) {
 }
 
 /**
- * Grades a candidate if they have answered the questions.
+ * Grades every candidate who has answered the questions, frees their seats
+ * and hands them to the waiting candidates. Each mutex is taken once per
+ * pass rather than once per seat.
  *
- * @param seat The seat of the candidate.
- * @return True if the candidate has been graded, false otherwise.
+ * @return The number of seats freed.
  */
-bool CommissionProcess::maybeGradeCandidate(int seat) {
-  pthread_mutex_t *commissionMutex = nullptr;
-  if (commissionType_ == 'A') {
-    commissionMutex = &SharedMemoryManager::data()->commissionAMutex;
-  } else {
-    commissionMutex = &SharedMemoryManager::data()->commissionBMutex;
-  }
-
-  pthread_mutex_t *candidatesMutex =
-      &SharedMemoryManager::data()->candidateMutex;
+template <typename Traits>
+int CommissionProcess<Traits>::gradeAnsweredSeats() {
+  SharedState *state = SharedMemoryManager::data();
+  pthread_mutex_t *commissionMutex = Traits::mutex(state, shard_);
+  pthread_mutex_t *candidatesMutex = &state->candidateMutex;
 
-  pthread_mutex_t *examStateMutex =
-      &SharedMemoryManager::data()->examStateMutex;
+  uint64_t gradingStart = Time::monotonicNs();
 
   try {
     MutexWrapper::lock(commissionMutex);
-    CommissionInfo *commissionInfo = commission();
-
-    if (!commissionInfo->seats[seat].answered ||
-        commissionInfo->seats[seat].pid == -1) {
-      MutexWrapper::unlock(commissionMutex);
-      return false;
+    CommissionInfo *commissionInfo = &Traits::info(state, shard_);
+
+    /* Seats answered, freed, and the candidates graded on them */
+    std::vector<int> answeredSeats;
+    std::vector<int> freedSeats;
+    std::vector<int> gradedCandidates;
+    int failed = 0;
+
+    for (int seat = 0; seat < commissionInfo->seatCount; seat++) {
+      if (commissionInfo->seat(seat).answered &&
+          commissionInfo->seat(seat).pid != -1) {
+        answeredSeats.push_back(seat);
+      }
     }
 
-    MutexWrapper::lock(candidatesMutex);
-    CandidateInfo *candidate = Memory::findCandidate(commissionType_, seat);
-    if (candidate == nullptr) {
-      Logger::warn("Seat " + std::to_string(seat) +
-                   " has answered flag but candidate not found, freeing seat");
-
-      MutexWrapper::unlock(candidatesMutex);
-
-      Memory::resetSeat(commissionType_, seat);
+    if (answeredSeats.empty()) {
       MutexWrapper::unlock(commissionMutex);
-
-      SemaphoreManager::post(semaphore);
-
-      return false;
+      return 0;
     }
 
-    double score = commissionType_ == 'A' ? candidate->theoreticalScore
-                                          : candidate->practicalScore;
-    if (score < 0) {
-      if (commissionType_ == 'A') {
-        candidate->theoreticalScore = Random::sampleMean(5, 0.0, 100.0);
-      } else {
-        candidate->practicalScore = Random::sampleMean(3, 0.0, 100.0);
+    MutexWrapper::lock(candidatesMutex);
+    for (int seat : answeredSeats) {
+      CandidateInfo *candidate =
+          Memory::findCandidate(Traits::type, shard_, seat);
+      if (candidate == nullptr) {
+        Logger::warn("Seat " + std::to_string(seat) +
+                     " has answered flag but candidate not found, freeing "
+                     "seat");
+        freedSeats.push_back(seat);
+        continue;
       }
 
-      candidatesProcessed++;
+      double &score = Traits::score(candidate);
+      if (score >= 0) {
+        continue;
+      }
 
-      MutexWrapper::lock(examStateMutex);
-      if (commissionType_ == 'A' && candidate->theoreticalScore < 30) {
-        SharedMemoryManager::data()->commissionBCandidateCount -= 1;
+      /* Mean of the grades of all members, published to the lock-free
+       * readers together with the status */
+      double grade =
+          Random::sampleMean(commissionInfo->memberCount, 0.0, 100.0);
+      CandidateStatus status = Traits::gradedStatus(grade);
+
+      candidate->scoreSequence.beginWrite();
+      score = grade;
+      Memory::setStatus(candidate, status);
+      candidate->scoreSequence.endWrite();
+      if (status == Failed) {
+        failed++;
       }
 
-      double percentage =
-          candidatesProcessed / (double)totalCandidates() * 100.0;
+      freedSeats.push_back(seat);
+      gradedCandidates.push_back(
+          static_cast<int>(candidate - state->candidates));
+    }
+    MutexWrapper::unlock(candidatesMutex);
 
-      MutexWrapper::unlock(examStateMutex);
+    int graded = static_cast<int>(gradedCandidates.size());
+    double percentage = 0.0;
+    if (graded > 0) {
+      Traits::processedCount(state, shard_).fetch_add(
+          graded, std::memory_order_relaxed);
+      state->metrics.commissions[Traits::index].graded += graded;
+
+      /* Candidates who failed do not take the next part */
+      if (failed > 0) {
+        state->commissionBCandidateCount.value.fetch_sub(
+            failed, std::memory_order_release);
+      }
 
-      Logger::info("% of candidates graded: " + std::to_string(percentage) +
-                   "%");
+      /* Counted over all shards of the commission, published after the
+       * scores for the completion checks */
+      int total = Traits::gradedCount(state).fetch_add(
+                      graded, std::memory_order_release) +
+                  graded;
+      percentage =
+          total /
+          (double)Traits::candidateCount(state).load(
+              std::memory_order_relaxed) *
+          100.0;
+    }
 
-      MutexWrapper::unlock(candidatesMutex);
-      MutexWrapper::unlock(commissionMutex);
+    for (int seat : freedSeats) {
+      Memory::resetSeat(Traits::type, shard_, seat);
+      Memory::handOffSeat(Traits::type, shard_, seat);
+    }
+    MutexWrapper::unlock(commissionMutex);
 
-      return true;
+    if (graded > 0) {
+      Logger::info("Graded " + std::to_string(graded) +
+                   " candidates, % of candidates graded: " +
+                   std::to_string(percentage) + "%");
     }
 
-    MutexWrapper::unlock(candidatesMutex);
-    MutexWrapper::unlock(commissionMutex);
+    uint64_t gradingEnd = Time::monotonicNs();
+    for (int index : gradedCandidates) {
+      Tracer::complete("commission", "grade", gradingStart, gradingEnd, index);
+    }
 
-    return false;
+    return static_cast<int>(freedSeats.size());
   } catch (const std::exception &e) {
     std::string errorMessage =
-        "Failed to grade candidate: " + std::string(e.what());
+        "Failed to grade candidates: " + std::string(e.what());
     handleError(errorMessage.c_str());
   }
+
+  return 0;
+}
+
+/**
+ * Checks whether all candidates of the commission type have been graded,
+ * over all its shards, without taking a mutex. The graded count only grows
+ * and the candidate count only shrinks, so once true the result stays true.
+ *
+ * @return True if all candidates have been graded, false otherwise.
+ */
+template <typename Traits> bool CommissionProcess<Traits>::allGraded() {
+  SharedState *state = SharedMemoryManager::data();
+
+  /* Acquire pairs with the release of the grading commissions, the scores
+   * of every graded candidate are visible afterwards */
+  int graded = Traits::gradedCount(state).load(std::memory_order_acquire);
+  return graded >=
+         Traits::candidateCount(state).load(std::memory_order_acquire);
 }
 
 /**
  * Finishes the commission process if all candidates have been graded.
  */
-void CommissionProcess::maybeFinish() {
+template <typename Traits>
+void CommissionProcess<Traits>::maybeFinish() {
   pthread_mutex_t *examStateMutex =
       &SharedMemoryManager::data()->examStateMutex;
 
-  pthread_mutex_t *commissionMutex = nullptr;
-  if (commissionType_ == 'A') {
-    commissionMutex = &SharedMemoryManager::data()->commissionAMutex;
-  } else {
-    commissionMutex = &SharedMemoryManager::data()->commissionBMutex;
+  pthread_mutex_t *commissionMutex =
+      Traits::mutex(SharedMemoryManager::data(), shard_);
+
+  /* Every shard stops once all candidates of its type are graded. The
+   * check runs on every tick without taking a mutex */
+  if (!allGraded()) {
+    return;
   }
 
   try {
     MutexWrapper::lock(examStateMutex);
+    bool allSeatsEmpty = true;
 
-    if (candidatesProcessed >= totalCandidates()) {
-      bool allSeatsEmpty = true;
+    MutexWrapper::lock(commissionMutex);
+    CommissionInfo *commissionInfo =
+        &Traits::info(SharedMemoryManager::data(), shard_);
+
+    for (int i = 0; i < commissionInfo->seatCount; i++) {
+      if (commissionInfo->seat(i).pid != -1) {
+        Logger::info(std::string("Seat ") + std::to_string(i) +
+                     " is not empty");
+        allSeatsEmpty = false;
+        break;
+      }
+    }
 
-      MutexWrapper::lock(commissionMutex);
-      CommissionInfo *commissionInfo = commission();
+    MutexWrapper::unlock(commissionMutex);
 
-      for (int i = 0; i < 3; i++) {
-        if (commissionInfo->seats[i].pid != -1) {
-          Logger::info(std::string("Seat ") + std::to_string(i) +
-                       " is not empty");
-          allSeatsEmpty = false;
-          break;
-        }
-      }
+    if (allSeatsEmpty) {
+      Logger::info(
+          "All candidates processed (" +
+          std::to_string(
+              Traits::processedCount(SharedMemoryManager::data(), shard_)
+                  .load(std::memory_order_relaxed)) +
+          " by this shard, " +
+          std::to_string(Traits::candidateCount(SharedMemoryManager::data())
+                             .load(std::memory_order_relaxed)) +
+          " in total), finishing...");
+      leave();
+    }
 
-      MutexWrapper::unlock(commissionMutex);
+    MutexWrapper::unlock(examStateMutex);
+  } catch (const std::exception &e) {
+    std::string errorMessage =
+        "Failed to maybe finish: " + std::string(e.what());
+    handleError(errorMessage.c_str());
+  }
+}
 
-      if (allSeatsEmpty) {
-        Logger::info("All candidates processed (" +
-                     std::to_string(candidatesProcessed) + "/" +
-                     std::to_string(totalCandidates()) + "), finishing...");
-        running = false;
+/**
+ * Exits the commission process once the autoscaler has asked the shard to
+ * retire and every candidate queued for or seated at it has left.
+ */
+template <typename Traits>
+void CommissionProcess<Traits>::maybeRetire() {
+  pthread_mutex_t *examStateMutex =
+      &SharedMemoryManager::data()->examStateMutex;
 
-        if (commissionType_ == 'B') {
-          Logger::info("Commission B finished, ending exam");
-          SharedMemoryManager::data()->examStarted = false;
-        }
-      }
+  pthread_mutex_t *commissionMutex =
+      Traits::mutex(SharedMemoryManager::data(), shard_);
+
+  CommissionInfo &info = Traits::info(SharedMemoryManager::data(), shard_);
+  if (!running || !info.retiring) {
+    return;
+  }
 
-      MutexWrapper::unlock(examStateMutex);
-      return;
+  try {
+    MutexWrapper::lock(examStateMutex);
+    MutexWrapper::lock(commissionMutex);
+
+    /* Candidates check the flags under the shard mutex before queueing */
+    bool drained = info.load == 0;
+    if (drained) {
+      info.active = false;
+    }
+
+    MutexWrapper::unlock(commissionMutex);
+
+    if (drained) {
+      Logger::info("Commission " + std::string(1, Traits::type) + " shard " +
+                   std::to_string(shard_) + " retired after grading " +
+                   std::to_string(Traits::processedCount(
+                                      SharedMemoryManager::data(), shard_)
+                                      .load(std::memory_order_relaxed)) +
+                   " candidates");
+      leave();
     }
 
     MutexWrapper::unlock(examStateMutex);
   } catch (const std::exception &e) {
     std::string errorMessage =
-        "Failed to maybe finish: " + std::string(e.what());
+        "Failed to maybe retire: " + std::string(e.what());
     handleError(errorMessage.c_str());
   }
 }
+
+/**
+ * Stops the main loop and removes the shard from the running shards of its
+ * commission. Must be called with the examState mutex held.
+ */
+template <typename Traits> void CommissionProcess<Traits>::leave() {
+  running = false;
+  Traits::info(SharedMemoryManager::data(), shard_).active = false;
+
+  /* The last shard to leave ends the commission */
+  int active = --Traits::activeShards(SharedMemoryManager::data());
+  if (active == 0 && allGraded()) {
+    SharedMemoryManager::data()->timeline.commissionFinishedAt[Traits::index] =
+        Time::monotonicNs();
+
+    if (Traits::endsExam) {
+      Logger::info("Commission " + std::string(1, Traits::type) +
+                   " finished, ending exam");
+      SharedMemoryManager::data()->examStarted = false;
+    }
+  }
+}
+
+template class CommissionProcess<CommissionA>;
+template class CommissionProcess<CommissionB>;
@@ -1,15 +1,21 @@
 #include <iostream>
 
 #include "commission/CommissionProcess.h"
-#include "common/ipc/SemaphoreManager.h"
-#include "common/ipc/SharedMemoryManager.h"
-#include "common/output/Logger.h"
-#include "common/utils/Random.h"
+#include "common/ipc/CommissionTraits.h"
 #include <pthread.h>
 #include <unistd.h>
 
-int main(int argc, char *argv[]) {
-  CommissionProcess commissionProcess(argc, argv);
+namespace {
+
+/**
+ * Runs the commission process of the given kind.
+ *
+ * @param argc The number of arguments passed to the program.
+ * @param argv The arguments passed to the program.
+ * @return The exit status.
+ */
+template <typename Traits> int run(int argc, char *argv[]) {
+  CommissionProcess<Traits> commissionProcess(argc, argv);
 
   commissionProcess.waitForExamStart();
   commissionProcess.start();
@@ -17,3 +23,20 @@ int main(int argc, char *argv[]) {
 
   return 0;
 }
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  /* The commission kind is chosen at compile time, see CommissionTraits.h */
+  if (argc >= 2 && argv[1][0] == CommissionA::type) {
+    return run<CommissionA>(argc, argv);
+  }
+  if (argc >= 2 && argv[1][0] == CommissionB::type) {
+    return run<CommissionB>(argc, argv);
+  }
+
+  std::cerr << "Failed to validate arguments: \n\tInvalid commission type. "
+               "Usage: ./commission <type: A or B> [shard]"
+            << std::endl;
+  return 1;
+}
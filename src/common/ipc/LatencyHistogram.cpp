@@ -0,0 +1,98 @@
+#include "common/ipc/LatencyHistogram.h"
+
+/**
+ * Record a latency.
+ *
+ * @param micros The latency in microseconds.
+ */
+void LatencyHistogram::record(uint64_t micros) {
+  buckets[bucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+  sum.fetch_add(micros, std::memory_order_relaxed);
+
+  uint64_t current = max.load(std::memory_order_relaxed);
+  while (micros > current &&
+         !max.compare_exchange_weak(current, micros,
+                                    std::memory_order_relaxed)) {
+  }
+
+  count.fetch_add(1, std::memory_order_release);
+}
+
+/**
+ * Get the latency below which the given percentage of values fall.
+ *
+ * @param percent The percentile in range [0, 100].
+ * @return The latency in microseconds, or 0 if nothing has been recorded.
+ */
+uint64_t LatencyHistogram::percentile(double percent) const {
+  uint64_t total = count.load(std::memory_order_acquire);
+  if (total == 0) {
+    return 0;
+  }
+
+  uint64_t rank = static_cast<uint64_t>(percent / 100.0 * total + 0.5);
+  rank = rank == 0 ? 1 : rank;
+
+  uint64_t seen = 0;
+  for (int i = 0; i < bucketCount; i++) {
+    seen += buckets[i].load(std::memory_order_relaxed);
+    if (seen >= rank) {
+      uint64_t value = bucketValue(i);
+      uint64_t highest = max.load(std::memory_order_relaxed);
+      return value < highest ? value : highest;
+    }
+  }
+
+  return max.load(std::memory_order_relaxed);
+}
+
+/**
+ * Get the mean latency.
+ *
+ * @return The mean in microseconds, or 0 if nothing has been recorded.
+ */
+double LatencyHistogram::mean() const {
+  uint64_t total = count.load(std::memory_order_acquire);
+  return total == 0 ? 0.0
+                    : sum.load(std::memory_order_relaxed) /
+                          static_cast<double>(total);
+}
+
+/**
+ * Get the bucket of a latency.
+ *
+ * @param micros The latency in microseconds.
+ * @return The bucket index.
+ */
+int LatencyHistogram::bucketIndex(uint64_t micros) {
+  if (micros < static_cast<uint64_t>(linearBucketCount)) {
+    return static_cast<int>(micros);
+  }
+
+  int magnitude = 63 - __builtin_clzll(micros);
+  int level = magnitude - subBucketBits;
+  if (level > levelCount) {
+    return bucketCount - 1;
+  }
+
+  int subBucket = static_cast<int>(micros >> level) - subBucketCount;
+  return linearBucketCount + (level - 1) * subBucketCount + subBucket;
+}
+
+/**
+ * Get the representative (middle) value of a bucket.
+ *
+ * @param index The bucket index.
+ * @return The latency in microseconds.
+ */
+uint64_t LatencyHistogram::bucketValue(int index) {
+  if (index < linearBucketCount) {
+    return index;
+  }
+
+  int level = (index - linearBucketCount) / subBucketCount + 1;
+  uint64_t subBucket =
+      (index - linearBucketCount) % subBucketCount + subBucketCount;
+  uint64_t lowest = subBucket << level;
+  return lowest + ((1ULL << level) >> 1);
+}
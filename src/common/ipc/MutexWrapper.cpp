@@ -1,5 +1,9 @@
 #include "common/ipc/MutexWrapper.h"
 
+#include "common/ipc/SharedMemoryManager.h"
+#include "common/utils/Time.h"
+#include <algorithm>
+#include <cerrno>
 #include <cstring>
 #include <stdexcept>
 #include <string>
@@ -7,10 +11,38 @@
 /**
  * Lock a mutex.
  *
+ * With MUTEX_PROFILING the acquisition of the shared mutexes is recorded in
+ * the shared memory: a failed trylock counts as a contended acquisition.
+ *
  * @param mutex The mutex to lock.
  * @throw std::runtime_error If the mutex cannot be locked.
  */
 void MutexWrapper::lock(pthread_mutex_t *mutex) {
+#ifdef MUTEX_PROFILING
+  MutexStats *stats = statsFor(mutex);
+  if (stats != nullptr) {
+    uint64_t start = Time::monotonicNs();
+    int result = pthread_mutex_trylock(mutex);
+    bool contended = result == EBUSY;
+    if (contended) {
+      result = pthread_mutex_lock(mutex);
+    }
+    if (result != 0) {
+      throw std::runtime_error("pthread_mutex_lock failed: " +
+                               std::string(std::strerror(result)));
+    }
+
+    uint64_t acquired = Time::monotonicNs();
+    uint64_t wait = acquired - start;
+    stats->acquisitions++;
+    stats->contended += contended ? 1 : 0;
+    stats->waitNs += wait;
+    stats->maxWaitNs = std::max(stats->maxWaitNs, wait);
+    stats->lockedAt = acquired;
+    return;
+  }
+#endif
+
   int result = pthread_mutex_lock(mutex);
   if (result != 0) {
     throw std::runtime_error("pthread_mutex_lock failed: " +
@@ -25,9 +57,125 @@ void MutexWrapper::lock(pthread_mutex_t *mutex) {
  * @throw std::runtime_error If the mutex cannot be unlocked.
  */
 void MutexWrapper::unlock(pthread_mutex_t *mutex) {
+#ifdef MUTEX_PROFILING
+  MutexStats *stats = statsFor(mutex);
+  if (stats != nullptr && stats->lockedAt != 0) {
+    uint64_t hold = Time::monotonicNs() - stats->lockedAt;
+    stats->holdNs += hold;
+    stats->maxHoldNs = std::max(stats->maxHoldNs, hold);
+    stats->lockedAt = 0;
+  }
+#endif
+
   int result = pthread_mutex_unlock(mutex);
   if (result != 0) {
     throw std::runtime_error("pthread_mutex_unlock failed: " +
                              std::string(std::strerror(result)));
   }
 }
+
+/**
+ * Wait on a condition variable with the mutex held. The condition variable
+ * must use CLOCK_MONOTONIC when a timeout is given.
+ *
+ * With MUTEX_PROFILING the time spent waiting is not counted as holding the
+ * mutex.
+ *
+ * @param cond The condition variable.
+ * @param mutex The held mutex.
+ * @param timeoutMs The timeout in milliseconds, negative to wait indefinitely.
+ * @return False if the timeout expired, true otherwise.
+ * @throw std::runtime_error If the wait fails.
+ */
+bool MutexWrapper::wait(pthread_cond_t *cond, pthread_mutex_t *mutex,
+                        int timeoutMs) {
+#ifdef MUTEX_PROFILING
+  MutexStats *stats = statsFor(mutex);
+  if (stats != nullptr && stats->lockedAt != 0) {
+    uint64_t hold = Time::monotonicNs() - stats->lockedAt;
+    stats->holdNs += hold;
+    stats->maxHoldNs = std::max(stats->maxHoldNs, hold);
+    stats->lockedAt = 0;
+  }
+#endif
+
+  int result;
+  if (timeoutMs < 0) {
+    result = pthread_cond_wait(cond, mutex);
+  } else {
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeoutMs / 1000;
+    deadline.tv_nsec += (timeoutMs % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000L;
+    }
+    result = pthread_cond_timedwait(cond, mutex, &deadline);
+  }
+
+#ifdef MUTEX_PROFILING
+  if (stats != nullptr) {
+    stats->lockedAt = Time::monotonicNs();
+  }
+#endif
+
+  if (result != 0 && result != ETIMEDOUT) {
+    throw std::runtime_error("pthread_cond_wait failed: " +
+                             std::string(std::strerror(result)));
+  }
+
+  return result != ETIMEDOUT;
+}
+
+/**
+ * Get the name of a shared mutex.
+ *
+ * @param mutex The shared mutex.
+ * @return The name of the mutex.
+ */
+const char *MutexWrapper::name(SharedMutex mutex) {
+  switch (mutex) {
+  case CandidateMutex:
+    return "candidate";
+  case CommissionAMutex:
+    return "commissionA";
+  case CommissionBMutex:
+    return "commissionB";
+  case ExamStateMutex:
+    return "examState";
+  default:
+    return "unknown";
+  }
+}
+
+/**
+ * Get the contention counters of a mutex.
+ *
+ * @param mutex The mutex.
+ * @return The counters in the shared memory, or nullptr if the mutex is not
+ * one of the shared mutexes.
+ */
+MutexStats *MutexWrapper::statsFor(pthread_mutex_t *mutex) {
+  SharedState *state = SharedMemoryManager::data();
+  if (state == nullptr || state == (SharedState *)-1) {
+    return nullptr;
+  }
+
+  if (mutex == &state->candidateMutex) {
+    return &state->mutexStats[CandidateMutex][0];
+  }
+  if (mutex == &state->examStateMutex) {
+    return &state->mutexStats[ExamStateMutex][0];
+  }
+  for (int shard = 0; shard < maxCommissionShards; shard++) {
+    if (mutex == &state->commissionAMutex[shard]) {
+      return &state->mutexStats[CommissionAMutex][shard];
+    }
+    if (mutex == &state->commissionBMutex[shard]) {
+      return &state->mutexStats[CommissionBMutex][shard];
+    }
+  }
+
+  return nullptr;
+}
@@ -0,0 +1,72 @@
+#include "common/ipc/Namespace.h"
+
+#include <cstdlib>
+#include <regex>
+#include <stdexcept>
+
+/**
+ * Get the namespace of the run.
+ *
+ * @return The namespace, empty when EXAM_NAMESPACE is not set.
+ * @throw std::invalid_argument If EXAM_NAMESPACE is invalid.
+ */
+const std::string &Namespace::name() {
+  static const std::string instance = readName();
+  return instance;
+}
+
+/**
+ * Get the name of a POSIX IPC object (shared memory or semaphore) of the run.
+ *
+ * @param object The name of the object, e.g. "logger".
+ * @return The name of the object within the namespace.
+ */
+std::string Namespace::ipcName(const std::string &object) {
+  if (name().empty()) {
+    return "/exam." + object;
+  }
+  return "/exam." + name() + "." + object;
+}
+
+/**
+ * Get the output directory of the run.
+ *
+ * @return ../output, or ../output/<namespace> within a namespace.
+ */
+std::string Namespace::outputDirectory() {
+  if (name().empty()) {
+    return "../output";
+  }
+  return "../output/" + name();
+}
+
+/**
+ * Get the path of an output file of the run.
+ *
+ * @param file The name of the file.
+ * @return The path of the file in the output directory.
+ */
+std::string Namespace::outputPath(const std::string &file) {
+  return outputDirectory() + "/" + file;
+}
+
+/**
+ * Read and validate the EXAM_NAMESPACE environment variable.
+ *
+ * @return The namespace, empty when the variable is not set.
+ * @throw std::invalid_argument If the namespace is invalid.
+ */
+std::string Namespace::readName() {
+  const char *value = std::getenv("EXAM_NAMESPACE");
+  if (value == nullptr || value[0] == '\0') {
+    return "";
+  }
+
+  /* Used in IPC object names and paths: no slashes, bounded length */
+  if (!std::regex_match(value, std::regex("^[A-Za-z0-9_-]{1,32}$"))) {
+    throw std::invalid_argument(
+        "Invalid EXAM_NAMESPACE. Expected: 1-32 characters [A-Za-z0-9_-]");
+  }
+
+  return value;
+}
@@ -0,0 +1,92 @@
+#include "common/ipc/SeatScheduler.h"
+
+#include "common/ipc/SharedMemoryManager.h"
+#include "common/utils/Memory.h"
+#include "common/utils/Random.h"
+#include <stdexcept>
+
+namespace {
+
+const char *policyNames[SeatPolicyCount] = {"fifo", "sjf", "retake", "random"};
+
+} // namespace
+
+/**
+ * Parse the name of a seat policy.
+ *
+ * @param name The name: fifo, sjf, retake or random.
+ * @return The policy.
+ * @throw std::invalid_argument If the name is unknown.
+ */
+SeatPolicy SeatScheduler::parse(const std::string &name) {
+  for (int i = 0; i < SeatPolicyCount; i++) {
+    if (name == policyNames[i]) {
+      return static_cast<SeatPolicy>(i);
+    }
+  }
+
+  throw std::invalid_argument(
+      "Invalid seat policy. Expected: fifo, sjf, retake or random");
+}
+
+/**
+ * Get the name of a seat policy.
+ *
+ * @param policy The policy.
+ * @return The name.
+ */
+const char *SeatScheduler::name(SeatPolicy policy) {
+  return policyNames[policy];
+}
+
+/**
+ * Select the waiting candidate that receives the next freed seat of a shard.
+ * Must be called with the shard mutex held.
+ *
+ * @param commission The commission type.
+ * @param shard The shard.
+ * @return The index of the candidate, or -1 if nobody waits.
+ */
+int SeatScheduler::select(char commission, int shard) {
+  SharedState *state = SharedMemoryManager::data();
+  CandidateInfo *candidates = state->candidates;
+  int head = Memory::commission(commission, shard)->queueHead;
+
+  if (head == -1 || state->seatPolicy == FifoSeatPolicy) {
+    return head;
+  }
+
+  /* The queue is walked from its head, so ties go to the earliest arrival */
+  int selected = head;
+  int waiting = 0;
+  for (int i = head; i != -1; i = candidates[i].queueNext) {
+    const CandidateInfo &candidate = candidates[i];
+    const CandidateInfo &best = candidates[selected];
+    waiting++;
+
+    switch (state->seatPolicy) {
+    case ShortestJobSeatPolicy: {
+      int job = commission == 'A' ? 0 : 1;
+      if (candidate.expectedService[job] < best.expectedService[job]) {
+        selected = i;
+      }
+      break;
+    }
+    case RetakersFirstSeatPolicy:
+      if (candidate.retaking && !best.retaking) {
+        selected = i;
+      }
+      break;
+    case RandomSeatPolicy:
+      /* Reservoir sampling over the queue */
+      if (Random::randomInt(0, waiting - 1) == 0) {
+        selected = i;
+      }
+      break;
+    default:
+      break;
+    }
+  }
+
+  return selected;
+}
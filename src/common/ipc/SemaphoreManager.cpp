@@ -1,6 +1,7 @@
 #include "common/ipc/SemaphoreManager.h"
 #include <cerrno>
 #include <cstring>
+#include <ctime>
 #include <fcntl.h>
 
 /**
@@ -92,6 +93,37 @@ void SemaphoreManager::wait(sem_t *sem) {
   }
 }
 
+/**
+ * Wait on a semaphore, up to the given timeout.
+ *
+ * @param sem The semaphore to wait on.
+ * @param timeoutMs The timeout in milliseconds.
+ * @return True if the semaphore has been decremented, false on timeout.
+ * @throw std::runtime_error If the semaphore cannot be waited on.
+ */
+bool SemaphoreManager::timedWait(sem_t *sem, int timeoutMs) {
+  struct timespec deadline;
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  deadline.tv_sec += timeoutMs / 1000;
+  deadline.tv_nsec += (timeoutMs % 1000) * 1000000L;
+  if (deadline.tv_nsec >= 1000000000L) {
+    deadline.tv_sec++;
+    deadline.tv_nsec -= 1000000000L;
+  }
+
+  while (sem_timedwait(sem, &deadline) == -1) {
+    if (errno == ETIMEDOUT) {
+      return false;
+    }
+    if (errno != EINTR) {
+      throw std::runtime_error("Failed to wait on semaphore: " +
+                               std::string(strerror(errno)));
+    }
+  }
+
+  return true;
+}
+
 /**
  * Post to a semaphore.
  *
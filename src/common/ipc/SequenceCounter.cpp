@@ -0,0 +1,74 @@
+#include "common/ipc/SequenceCounter.h"
+
+/**
+ * Constructor for the sequence counter. Counters in the shared memory are
+ * zero-filled instead.
+ */
+SequenceCounter::SequenceCounter() : sequence(0) {}
+
+/**
+ * Copy constructor, copies the current value of the counter.
+ *
+ * @param other The counter to copy.
+ */
+SequenceCounter::SequenceCounter(const SequenceCounter &other)
+    : sequence(other.sequence.load(std::memory_order_relaxed)) {}
+
+/**
+ * Copy assignment, copies the current value of the counter.
+ *
+ * @param other The counter to copy.
+ * @return The counter.
+ */
+SequenceCounter &SequenceCounter::operator=(const SequenceCounter &other) {
+  sequence.store(other.sequence.load(std::memory_order_relaxed),
+                 std::memory_order_relaxed);
+  return *this;
+}
+
+/**
+ * Starts an update of the protected fields. The caller must hold the mutex
+ * serializing the writers.
+ */
+void SequenceCounter::beginWrite() {
+  sequence.store(sequence.load(std::memory_order_relaxed) + 1,
+                 std::memory_order_relaxed);
+  /* The odd value becomes visible before any of the field stores */
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+/**
+ * Finishes an update of the protected fields.
+ */
+void SequenceCounter::endWrite() {
+  /* Orders the field stores before the even value */
+  sequence.store(sequence.load(std::memory_order_relaxed) + 1,
+                 std::memory_order_release);
+}
+
+/**
+ * Starts a lock-free read of the protected fields, waiting for an update in
+ * progress to finish.
+ *
+ * @return The value to pass to retryRead().
+ */
+unsigned SequenceCounter::beginRead() const {
+  unsigned start = sequence.load(std::memory_order_acquire);
+  while (start & 1) {
+    start = sequence.load(std::memory_order_acquire);
+  }
+  return start;
+}
+
+/**
+ * Checks whether a read has to be repeated because the fields were updated
+ * while being copied.
+ *
+ * @param start The value returned by beginRead().
+ * @return True if the copy is inconsistent and must be repeated.
+ */
+bool SequenceCounter::retryRead(unsigned start) const {
+  /* Orders the field loads before the second load of the counter */
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return sequence.load(std::memory_order_relaxed) != start;
+}
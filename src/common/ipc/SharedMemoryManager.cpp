@@ -1,8 +1,20 @@
 #include "common/ipc/SharedMemoryManager.h"
 
+#include "common/ipc/Namespace.h"
 #include "common/output/Logger.h"
+#include <cerrno>
+#include <cstdlib>
 #include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
 #include <stdexcept>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const char *SharedMemoryManager::hugePageDirectory = "/dev/hugepages";
 
 /**
  *  Get the shared memory instance.
@@ -19,7 +31,7 @@ SharedMemoryManager &SharedMemoryManager::shared() {
  */
 SharedMemoryManager::~SharedMemoryManager() {
   if (data_ != nullptr && data_ != (SharedState *)-1) {
-    int result = shmdt(data_);
+    int result = munmap(data_, size_);
     if (result == -1) {
       std::string errorMessage = "Failed to detach from shared memory: " +
                                  std::string(std::strerror(errno));
@@ -32,59 +44,116 @@ SharedMemoryManager::~SharedMemoryManager() {
 /**
  * Initialize the shared memory manager.
  *
+ * With the hugepages option the shared memory is backed by a file on
+ * hugetlbfs, falling back to transparent huge pages and then to regular
+ * pages when huge pages are unavailable.
+ *
  * @param count The number of candidates.
+ * @param seatCount The number of seats of all commissions.
+ * @param taskCount The number of question tasks of all commissions.
  * @throw std::runtime_error If the shared memory cannot be initialized.
  */
-void SharedMemoryManager::initialize(int count) {
+void SharedMemoryManager::initialize(int count, int seatCount, int taskCount) {
   Logger::info("SharedMemoryManager::initialize(" + std::to_string(count) +
-               ")");
-  key_t key = getKey();
-  Logger::info("Initializing shared memory for key: " + std::to_string(key));
+               ", " + std::to_string(seatCount) + ", " +
+               std::to_string(taskCount) + ")");
+  size_t size = getSize(count, seatCount, taskCount);
+  shared().owner_ = true;
+
+  if (options() & HugePagesOption) {
+    /* Huge pages are allocated whole */
+    size_t hugeSize = (size + hugePageSize - 1) / hugePageSize * hugePageSize;
+    if (createHugePages(hugeSize)) {
+      memset(shared().data_, 0, hugeSize);
+      recordPrefault();
+      return;
+    }
+    if (transparentHugePagesAvailable()) {
+      size = hugeSize;
+    } else {
+      Logger::warn("Huge pages are unavailable, using regular pages");
+    }
+  }
 
-  int tempId = shmget(key, 1, 0600);
-  if (tempId != -1) {
+  std::string name = getName();
+  Logger::info("Initializing shared memory: " + name);
+
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd == -1 && errno == EEXIST) {
+    /* Left behind by a crashed run of the same namespace */
     Logger::warn("Shared memory already exists. Cleaning up...");
-    if (shmctl(tempId, IPC_RMID, NULL) == -1) {
+    if (shm_unlink(name.c_str()) == -1 && errno != ENOENT) {
       throw std::runtime_error(
           "Failed to clean up already existing shared memory");
     }
+    fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  }
+  if (fd == -1) {
+    throw std::runtime_error("Failed to create new shared memory: " +
+                             std::string(std::strerror(errno)));
   }
 
-  size_t size = getSize(count);
   Logger::info("Creating new shared memory with size: " + std::to_string(size) +
                " bytes");
-  shared().shmId_ = shmget(key, size, IPC_CREAT | IPC_EXCL | 0600);
-  if (shared().shmId_ == -1) {
-    throw std::runtime_error("Failed to create new shared memory");
+  if (ftruncate(fd, size) == -1) {
+    int error = errno;
+    close(fd);
+    throw std::runtime_error("Failed to resize shared memory: " +
+                             std::string(std::strerror(error)));
   }
 
-  shared().data_ = (SharedState *)shmat(shared().shmId_, nullptr, 0);
-  if (shared().data_ == (SharedState *)-1) {
-    throw std::runtime_error("Failed to attach to shared memory");
-  }
+  shared().data_ = map(fd, size, false);
+  shared().size_ = size;
 
   memset(shared().data_, 0, size);
+  recordPrefault();
 }
 
 /**
- * Attach to the shared memory.
+ * Attach to the shared memory. A read-only attach is the one of an observer
+ * (examtop): it does not log, since the logger waits on the semaphore of the
+ * run and appends to its log, and it does not lock the mapping.
  *
+ * @param readOnly Whether to attach the shared memory read-only.
  * @throw std::runtime_error If the shared memory cannot be attached.
  */
-void SharedMemoryManager::attach() {
-  key_t key = getKey();
-  Logger::info("Attaching to shared memory with key: " + std::to_string(key));
+void SharedMemoryManager::attach(bool readOnly) {
+  int flags = readOnly ? O_RDONLY : O_RDWR;
+  shared().quiet_ = readOnly;
+
+  /* The dean may have fallen back to a shm_open object */
+  int fd = -1;
+  if (options() & HugePagesOption) {
+    fd = open(getHugePagePath().c_str(), flags);
+    shared().hugetlbfs_ = fd != -1;
+  }
 
-  Logger::info("Getting shared memory for key: " + std::to_string(key));
-  int shmId = shmget(key, 0, 0600);
-  if (shmId == -1) {
-    throw std::runtime_error("Failed to get shared memory for key: " +
-                             std::to_string(key));
+  if (fd == -1) {
+    std::string name = getName();
+    if (!shared().quiet_) {
+      Logger::info("Attaching to shared memory: " + name);
+    }
+
+    fd = shm_open(name.c_str(), flags, 0600);
+    if (fd == -1) {
+      throw std::runtime_error("Failed to get shared memory " + name + ": " +
+                               std::string(std::strerror(errno)));
+    }
   }
 
-  shared().data_ = (SharedState *)shmat(shmId, NULL, 0);
-  if (shared().data_ == (SharedState *)-1) {
-    throw std::runtime_error("Failed to attach to shared memory");
+  /* The size depends on the candidate count chosen by the dean */
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    int error = errno;
+    close(fd);
+    throw std::runtime_error("Failed to stat shared memory: " +
+                             std::string(std::strerror(error)));
+  }
+
+  shared().data_ = map(fd, st.st_size, readOnly);
+  shared().size_ = st.st_size;
+  if (!shared().quiet_) {
+    recordPrefault();
   }
 }
 
@@ -94,11 +163,13 @@ void SharedMemoryManager::attach() {
  * @throw std::runtime_error If the shared memory cannot be detached.
  */
 void SharedMemoryManager::detach() {
-  Logger::info("SharedMemoryManager::detach()");
-  Logger::info("Detaching from shared memory");
+  if (!shared().quiet_) {
+    Logger::info("SharedMemoryManager::detach()");
+    Logger::info("Detaching from shared memory");
+  }
 
-  if (shared().data_ != (SharedState *)-1) {
-    if (shmdt(shared().data_) == -1) {
+  if (shared().data_ != nullptr && shared().data_ != (SharedState *)-1) {
+    if (munmap(shared().data_, shared().size_) == -1) {
       throw std::runtime_error("Failed to detach from shared memory");
     }
     shared().data_ = nullptr;
@@ -106,20 +177,22 @@ void SharedMemoryManager::detach() {
 }
 
 /**
- * Destroy the shared memory.
+ * Destroy the shared memory. The mapping stays valid until it is detached.
  *
  * @throw std::runtime_error If the shared memory cannot be destroyed.
  */
 void SharedMemoryManager::destroy() {
   Logger::info("SharedMemoryManager::destroy()");
-  Logger::info("Destroying shared memory with id: " +
-               std::to_string(shared().shmId_));
+  Logger::info("Destroying shared memory: " +
+               (shared().hugetlbfs_ ? getHugePagePath() : getName()));
 
-  if (shared().shmId_ != -1) {
-    if (shmctl(shared().shmId_, IPC_RMID, NULL) == -1) {
+  if (shared().owner_) {
+    int result = shared().hugetlbfs_ ? unlink(getHugePagePath().c_str())
+                                     : shm_unlink(getName().c_str());
+    if (result == -1 && errno != ENOENT) {
       throw std::runtime_error("Failed to destroy shared memory");
     }
-    shared().shmId_ = -1;
+    shared().owner_ = false;
   }
 }
 
@@ -131,24 +204,230 @@ void SharedMemoryManager::destroy() {
 SharedState *SharedMemoryManager::data() { return shared().data_; }
 
 /**
- * Get the key for the shared memory.
+ * Get the name of the shared memory object of the run.
+ *
+ * @return The name of the shared memory object.
+ */
+std::string SharedMemoryManager::getName() {
+  return Namespace::ipcName("shm");
+}
+
+/**
+ * Describe how the shared memory of this process is backed.
  *
- * @return The key for the shared memory.
+ * @return The page size and the options in effect.
  */
-key_t SharedMemoryManager::getKey() {
-  key_t key = ftok("/tmp", 155);
-  if (key == -1) {
-    throw std::runtime_error("Failed to get key for shared memory");
+std::string SharedMemoryManager::mode() {
+  std::string mode = shared().hugetlbfs_        ? "huge pages (hugetlbfs)"
+                     : shared().transparentHuge_ ? "huge pages (THP)"
+                                                 : "regular pages";
+  if (options() & PrefaultOption) {
+    mode += ", prefault";
   }
-  return key;
+  if (shared().locked_) {
+    mode += ", mlock";
+  }
+  return mode;
+}
+
+/**
+ * Get the path of the shared memory file on hugetlbfs.
+ *
+ * @return The path of the file.
+ */
+std::string SharedMemoryManager::getHugePagePath() {
+  return hugePageDirectory + getName();
+}
+
+/**
+ * Get the options of the shared memory, read once from EXAM_SHM_OPTIONS: a
+ * comma-separated list of hugepages, prefault and lock. The variable is
+ * inherited by the children, so every process maps the memory the same way.
+ *
+ * @return The options as a bitmask of SharedMemoryOption.
+ * @throw std::invalid_argument If an option is unknown.
+ */
+int SharedMemoryManager::options() {
+  static const int instance = [] {
+    const char *value = std::getenv("EXAM_SHM_OPTIONS");
+    int result = 0;
+    std::stringstream ss(value != nullptr ? value : "");
+    std::string option;
+    while (std::getline(ss, option, ',')) {
+      if (option == "hugepages") {
+        result |= HugePagesOption;
+      } else if (option == "prefault") {
+        result |= PrefaultOption;
+      } else if (option == "lock") {
+        result |= LockOption;
+      } else if (!option.empty()) {
+        throw std::invalid_argument("Unknown shared memory option: " + option +
+                                    ". Expected: hugepages, prefault, lock");
+      }
+    }
+    return result;
+  }();
+  return instance;
+}
+
+/**
+ * Create and map the shared memory as a file on hugetlbfs.
+ *
+ * @param size The size of the shared memory, a multiple of the huge page size.
+ * @return False if huge pages are unavailable.
+ */
+bool SharedMemoryManager::createHugePages(size_t size) {
+  std::string path = getHugePagePath();
+  unlink(path.c_str());
+
+  int fd = open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd == -1) {
+    Logger::warn("Failed to create " + path + ": " +
+                 std::string(std::strerror(errno)));
+    return false;
+  }
+
+  /* Fails without enough reserved huge pages (vm.nr_hugepages) */
+  long faultsBefore = minorFaults();
+  void *address = MAP_FAILED;
+  if (ftruncate(fd, size) == 0) {
+    address = mmap(nullptr, size, PROT_READ | PROT_WRITE, mapFlags(), fd, 0);
+  }
+  int error = errno;
+  shared().prefaultFaults_ = minorFaults() - faultsBefore;
+  close(fd);
+  if (address == MAP_FAILED) {
+    Logger::warn("Failed to map huge pages: " +
+                 std::string(std::strerror(error)));
+    unlink(path.c_str());
+    return false;
+  }
+
+  Logger::info("Created shared memory on huge pages: " + path + " (" +
+               std::to_string(size) + " bytes)");
+  shared().hugetlbfs_ = true;
+  shared().data_ = (SharedState *)address;
+  shared().size_ = size;
+  lock();
+  return true;
+}
+
+/**
+ * Check whether shared memory can use transparent huge pages.
+ *
+ * @return True if the kernel allows huge pages for madvise()d shared memory.
+ */
+bool SharedMemoryManager::transparentHugePagesAvailable() {
+  std::ifstream file("/sys/kernel/mm/transparent_hugepage/shmem_enabled");
+  std::string setting;
+  std::getline(file, setting);
+  return setting.find("[always]") != std::string::npos ||
+         setting.find("[within_size]") != std::string::npos ||
+         setting.find("[advise]") != std::string::npos ||
+         setting.find("[force]") != std::string::npos;
+}
+
+/**
+ * Get the mmap() flags of the shared memory.
+ *
+ * @return The flags.
+ */
+int SharedMemoryManager::mapFlags() {
+  return MAP_SHARED | ((options() & PrefaultOption) ? MAP_POPULATE : 0);
+}
+
+/**
+ * Lock the mapping in memory if requested, leaving it unlocked when
+ * RLIMIT_MEMLOCK does not allow it.
+ */
+void SharedMemoryManager::lock() {
+  if (!(options() & LockOption)) {
+    return;
+  }
+
+  if (mlock(shared().data_, shared().size_) == -1) {
+    Logger::warn("Failed to lock shared memory: " +
+                 std::string(std::strerror(errno)));
+    return;
+  }
+  shared().locked_ = true;
+}
+
+/**
+ * Get the minor page faults taken by this process so far.
+ *
+ * @return The number of minor page faults.
+ */
+long SharedMemoryManager::minorFaults() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_minflt;
+}
+
+/**
+ * Map the shared memory object and close its descriptor. The page faults
+ * taken up front by the prefault option are kept for recordPrefault().
+ *
+ * @param fd The descriptor of the shared memory object.
+ * @param size The size of the shared memory.
+ * @param readOnly Whether to map the shared memory read-only.
+ * @return The mapped shared memory.
+ * @throw std::runtime_error If the shared memory cannot be mapped.
+ */
+SharedState *SharedMemoryManager::map(int fd, size_t size, bool readOnly) {
+  long faultsBefore = minorFaults();
+  void *address = mmap(nullptr, size,
+                       readOnly ? PROT_READ : PROT_READ | PROT_WRITE,
+                       mapFlags(), fd, 0);
+  int error = errno;
+  close(fd);
+  shared().prefaultFaults_ = minorFaults() - faultsBefore;
+  if (address == MAP_FAILED) {
+    throw std::runtime_error("Failed to attach to shared memory: " +
+                             std::string(std::strerror(error)));
+  }
+
+  shared().data_ = (SharedState *)address;
+  shared().size_ = size;
+
+  if (!shared().hugetlbfs_ && size % hugePageSize == 0 &&
+      (options() & HugePagesOption)) {
+    shared().transparentHuge_ =
+        madvise(address, size, MADV_HUGEPAGE) == 0;
+  }
+  if (shared().quiet_) {
+    return (SharedState *)address;
+  }
+  lock();
+
+  return (SharedState *)address;
+}
+
+/**
+ * Log the page faults taken up front by the prefault option and add them to
+ * the total of all processes. Called once the shared memory is initialized,
+ * since the dean zeroes it after mapping.
+ */
+void SharedMemoryManager::recordPrefault() {
+  if (!(options() & PrefaultOption)) {
+    return;
+  }
+
+  Logger::info("Prefaulted shared memory (" + mode() + "): " +
+               std::to_string(shared().prefaultFaults_) +
+               " page faults taken up front");
+  shared().data_->prefaultFaults += shared().prefaultFaults_;
 }
 
 /**
  * Get the size of the shared memory.
  *
  * @param count The number of candidates.
+ * @param seatCount The number of seats of all commissions.
+ * @param taskCount The number of question tasks of all commissions.
  * @return The size of the shared memory.
  */
-size_t SharedMemoryManager::getSize(int count) {
-  return sizeof(SharedState) + sizeof(CandidateInfo) * count;
+size_t SharedMemoryManager::getSize(int count, int seatCount, int taskCount) {
+  return sizeof(SharedState) + sizeof(CandidateInfo) * count +
+         sizeof(CommissionSeat) * seatCount + sizeof(QuestionTask) * taskCount;
 }
@@ -1,5 +1,6 @@
 #include "common/output/Logger.h"
 
+#include "common/ipc/Namespace.h"
 #include "common/ipc/SemaphoreManager.h"
 #include <cerrno>
 #include <chrono>
@@ -18,22 +19,25 @@ Logger &Logger::shared() {
 }
 
 Logger::Logger() {
-  const char *outputDirectory = "../output";
-  struct stat st;
-  if (stat(outputDirectory, &st) == -1) {
-    if (errno == ENOENT) {
-      if (mkdir(outputDirectory, 0755) == -1) {
-        throw std::runtime_error("Failed to create output directory: " +
+  /* ../output and, within a namespace, ../output/<namespace> */
+  for (const std::string &outputDirectory :
+       {std::string("../output"), Namespace::outputDirectory()}) {
+    struct stat st;
+    if (stat(outputDirectory.c_str(), &st) == -1) {
+      if (errno == ENOENT) {
+        if (mkdir(outputDirectory.c_str(), 0755) == -1 && errno != EEXIST) {
+          throw std::runtime_error("Failed to create output directory: " +
+                                   std::string(strerror(errno)));
+        }
+      } else {
+        throw std::runtime_error("Failed to stat output directory: " +
                                  std::string(strerror(errno)));
       }
-    } else {
-      throw std::runtime_error("Failed to stat output directory: " +
-                               std::string(strerror(errno)));
     }
   }
 
-  fileHandle_ =
-      open("../output/simulation.log", O_CREAT | O_WRONLY | O_APPEND, 0644);
+  fileHandle_ = open(Namespace::outputPath("simulation.log").c_str(),
+                     O_CREAT | O_WRONLY | O_APPEND, 0644);
   if (fileHandle_ == -1) {
     throw std::runtime_error("Failed to open log file: " +
                              std::string(strerror(errno)));
@@ -79,18 +83,24 @@ void Logger::log(const std::string &message, const std::string &logLevel) {
 
   if (logSemaphore_ == nullptr) {
     try {
-      logSemaphore_ = SemaphoreManager::open("logger");
+      logSemaphore_ = SemaphoreManager::open(Namespace::ipcName("logger"));
     } catch (const std::exception &e) {
       return;
     }
   }
 
-  try {
-    SemaphoreManager::wait(logSemaphore_);
-  } catch (const std::exception &e) {
-    throw std::runtime_error("Failed to acquire logger semaphore: " +
-                             std::string(e.what()));
-    return;
+  /* The log file is opened with O_APPEND, so a line written without the
+   * semaphore is still not split */
+  bool acquired = false;
+  if (!semaphoreAbandoned_) {
+    try {
+      acquired =
+          SemaphoreManager::timedWait(logSemaphore_, semaphoreTimeoutMs);
+    } catch (const std::exception &e) {
+      throw std::runtime_error("Failed to acquire logger semaphore: " +
+                               std::string(e.what()));
+    }
+    semaphoreAbandoned_ = !acquired;
   }
 
   std::string logMessage = getPrefix(logLevel) + " " + message + "\n";
@@ -116,6 +126,10 @@ void Logger::log(const std::string &message, const std::string &logLevel) {
                              std::string(strerror(errno)));
   }
 
+  if (!acquired) {
+    return;
+  }
+
   try {
     SemaphoreManager::post(logSemaphore_);
   } catch (const std::exception &e) {
@@ -125,7 +139,8 @@ void Logger::log(const std::string &message, const std::string &logLevel) {
 }
 
 void Logger::setupLogFile() {
-  if (unlink("../output/simulation.log") == -1 && errno != ENOENT) {
+  if (unlink(Namespace::outputPath("simulation.log").c_str()) == -1 &&
+      errno != ENOENT) {
     throw std::runtime_error("Failed to remove existing log file: " +
                              std::string(strerror(errno)));
   }
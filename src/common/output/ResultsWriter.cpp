@@ -1,33 +1,119 @@
 #include "common/output/ResultsWriter.h"
 
+#include "common/ipc/MutexWrapper.h"
+#include "common/ipc/Namespace.h"
 #include "common/ipc/SharedMemoryManager.h"
 #include "common/output/Logger.h"
+#include "common/utils/Memory.h"
 #include <fcntl.h>
 #include <algorithm>
+#include <cerrno>
 #include <cstring>
 #include <stdexcept>
+#include <unistd.h>
 #include <vector>
 
-const char *ResultsWriter::fileName = "../output/lista_rankingowa.txt";
+const char *ResultsWriter::fileName = "lista_rankingowa.txt";
+const char *ResultsWriter::timelineFileName = "timeline.csv";
+const char *ResultsWriter::mutexReportFileName = "mutex_contention.txt";
 
-void ResultsWriter::publishResults(bool evacuation) {
-  calculateScores(evacuation);
+namespace {
 
-  int result = unlink(fileName);
-  if (result != 0 && errno != ENOENT) {
-    std::string errorMessage = "Failed to unlink file " +
-                               std::string(fileName) + ": " +
-                               std::strerror(errno);
-    throw std::runtime_error(errorMessage);
+/**
+ * Convert a monotonic timestamp to seconds since the exam start.
+ *
+ * @param timestamp The timestamp in nanoseconds, 0 if not recorded.
+ * @param origin The exam start timestamp in nanoseconds.
+ * @return The time in seconds, or -1 if the timestamp has not been recorded.
+ */
+std::string relativeSeconds(uint64_t timestamp, uint64_t origin) {
+  if (timestamp == 0) {
+    return "-1";
   }
 
-  int fileDescriptor = open(fileName, O_CREAT | O_WRONLY | O_TRUNC, 0600);
-  if (fileDescriptor == -1) {
-    std::string errorMessage = "Failed to open file " + std::string(fileName) +
-                               ": " + std::strerror(errno);
-    throw std::runtime_error(errorMessage);
+  return std::to_string((static_cast<int64_t>(timestamp) -
+                         static_cast<int64_t>(origin)) /
+                        1e9);
+}
+
+} // namespace
+
+/**
+ * Publish the ranking of the candidates stored in the shared memory.
+ *
+ * @param evacuation Whether the exam has been interrupted by an evacuation.
+ * @param appendix Additional content appended after the latency summary.
+ */
+void ResultsWriter::publishResults(bool evacuation,
+                                   const std::string &appendix) {
+  SharedState *state = SharedMemoryManager::data();
+
+  /* The ranking is computed on a copy, with the scores read without the
+   * candidate mutex: commissions may still be grading during an evacuation */
+  std::vector<CandidateInfo> candidates(
+      state->candidates, state->candidates + state->candidateCount);
+  for (int i = 0; i < state->candidateCount; i++) {
+    CandidateScores scores = Memory::readScores(&state->candidates[i]);
+    candidates[i].theoreticalScore = scores.theoreticalScore;
+    candidates[i].practicalScore = scores.practicalScore;
+    candidates[i].finalScore = scores.finalScore;
+    candidates[i].status = scores.status;
   }
 
+  publishResults(candidates.data(), state->candidateCount, evacuation,
+                 Namespace::outputPath(fileName).c_str(),
+                 getLatencyContent() + appendix);
+}
+
+/**
+ * Get the summary of the phase latency histograms in the shared memory.
+ *
+ * @return The summary formatted as a table.
+ */
+std::string ResultsWriter::getLatencyContent() {
+  const char *phaseNames[LatencyPhaseCount] = {
+      "Oczekiwanie na miejsce", "Oczekiwanie na pytania", "Odpowiadanie",
+      "Oczekiwanie na ocene"};
+
+  std::string content = "\n| ==== Czasy faz egzaminu ==== |\n";
+  content += "| Faza | Liczba | Srednia [ms] | p50 [ms] | p90 [ms] | p99 [ms] "
+             "| Max [ms] |\n";
+  content += "|------|--------|--------------|----------|----------|----------"
+             "|----------|\n";
+
+  for (int commission = 0; commission < 2; commission++) {
+    for (int phase = 0; phase < LatencyPhaseCount; phase++) {
+      const LatencyHistogram &histogram =
+          SharedMemoryManager::data()->latency[commission][phase];
+      content += "| " + std::string(phaseNames[phase]) + " (" +
+                 (commission == 0 ? "A" : "B") + ") | " +
+                 std::to_string(histogram.count.load()) + " | " +
+                 std::to_string(histogram.mean() / 1000.0) + " | " +
+                 std::to_string(histogram.percentile(50.0) / 1000.0) + " | " +
+                 std::to_string(histogram.percentile(90.0) / 1000.0) + " | " +
+                 std::to_string(histogram.percentile(99.0) / 1000.0) + " | " +
+                 std::to_string(histogram.max.load() / 1000.0) + " |\n";
+    }
+  }
+
+  return content;
+}
+
+/**
+ * Publish the ranking of the given candidates.
+ *
+ * @param candidates The candidates.
+ * @param count The number of candidates.
+ * @param evacuation Whether the exam has been interrupted by an evacuation.
+ * @param path The path of the ranking file.
+ * @param appendix Additional content appended after the ranking table.
+ * @throw std::runtime_error If the ranking cannot be written.
+ */
+void ResultsWriter::publishResults(CandidateInfo *candidates, int count,
+                                   bool evacuation, const char *path,
+                                   const std::string &appendix) {
+  calculateScores(candidates, count, evacuation);
+
   std::string content = std::string("| ==== Lista Rankingowa") +
                         (evacuation ? " (Ewakuacja)" : "") + " ==== |\n";
   content += "| PID | Numer | Matura | Cz. teoretyczna | Cz. "
@@ -35,7 +121,119 @@ void ResultsWriter::publishResults(bool evacuation) {
   content += "|-----|-------|--------|----------------|--------"
              "--------|----------------|\n";
 
-  content += getTableContent(evacuation);
+  content += getTableContent(candidates, count, evacuation);
+  content += appendix;
+
+  writeFile(path, content);
+}
+
+/**
+ * Publish the phase timestamps of every candidate as CSV (in seconds since
+ * the exam start), preceded by the exam-level timings as comment lines.
+ *
+ * @throw std::runtime_error If the file cannot be written.
+ */
+void ResultsWriter::publishTimeline() {
+  SharedState *state = SharedMemoryManager::data();
+  const ExamTimeline &exam = state->timeline;
+  uint64_t origin = exam.examStartedAt;
+
+  std::string content = "# spawn_s=" +
+                        std::to_string((exam.spawnFinishedAt -
+                                        exam.spawnStartedAt) /
+                                       1e9) +
+                        "\n";
+  content += "# commission_a_s=" +
+             relativeSeconds(exam.commissionFinishedAt[0], origin) + "\n";
+  content += "# commission_b_s=" +
+             relativeSeconds(exam.commissionFinishedAt[1], origin) + "\n";
+  content += "index,status";
+  for (const char *commission : {"a", "b"}) {
+    for (const char *phase :
+         {"queued", "seated", "questions", "answered", "graded"}) {
+      content += std::string(",") + phase + "_" + commission;
+    }
+  }
+  content += "\n";
+
+  for (int i = 0; i < state->candidateCount; i++) {
+    const CandidateInfo &candidate = state->candidates[i];
+    content += std::to_string(i) + "," + std::to_string(candidate.status);
+    for (const PhaseTimeline &phase : candidate.timeline.commissions) {
+      content += "," + relativeSeconds(phase.queuedAt, origin) + "," +
+                 relativeSeconds(phase.seatedAt, origin) + "," +
+                 relativeSeconds(phase.questionsAt, origin) + "," +
+                 relativeSeconds(phase.answeredAt, origin) + "," +
+                 relativeSeconds(phase.gradedAt, origin);
+    }
+    content += "\n";
+  }
+
+  writeFile(Namespace::outputPath(timelineFileName).c_str(), content);
+}
+
+/**
+ * Publish the contention report of the shared mutexes, recorded by
+ * MutexWrapper when built with MUTEX_PROFILING.
+ */
+void ResultsWriter::publishMutexReport() {
+  SharedState *state = SharedMemoryManager::data();
+  if (state == nullptr || state == (SharedState *)-1) {
+    return;
+  }
+
+  std::string content = "| ==== Rywalizacja o muteksy ==== |\n";
+  content += "| Muteks | Zajecia | Z rywalizacja | Czekanie [ms] | Max "
+             "czekanie [ms] | Trzymanie [ms] | Max trzymanie [ms] |\n";
+  content += "|--------|---------|---------------|---------------|------------"
+             "-------|----------------|--------------------|\n";
+
+  for (int i = 0; i < SharedMutexCount; i++) {
+    /* The commission mutexes are reported per shard */
+    int shardCount = i == CommissionAMutex   ? state->commissionAShardCount
+                     : i == CommissionBMutex ? state->commissionBShardCount
+                                             : 1;
+    for (int shard = 0; shard < shardCount; shard++) {
+      const MutexStats &stats = state->mutexStats[i][shard];
+      std::string name = MutexWrapper::name(SharedMutex(i));
+      if (shardCount > 1) {
+        name += "[" + std::to_string(shard) + "]";
+      }
+      content += "| " + name + " | " + std::to_string(stats.acquisitions) +
+                 " | " + std::to_string(stats.contended) + " | " +
+                 std::to_string(stats.waitNs / 1e6) + " | " +
+                 std::to_string(stats.maxWaitNs / 1e6) + " | " +
+                 std::to_string(stats.holdNs / 1e6) + " | " +
+                 std::to_string(stats.maxHoldNs / 1e6) + " |\n";
+    }
+  }
+
+  std::string path = Namespace::outputPath(mutexReportFileName);
+  writeFile(path.c_str(), content);
+  Logger::info("Mutex contention report written to " + path);
+}
+
+/**
+ * Replace the file with the given content.
+ *
+ * @param path The path of the file.
+ * @param content The content to write.
+ * @throw std::runtime_error If the file cannot be written.
+ */
+void ResultsWriter::writeFile(const char *path, const std::string &content) {
+  int result = unlink(path);
+  if (result != 0 && errno != ENOENT) {
+    std::string errorMessage = "Failed to unlink file " + std::string(path) +
+                               ": " + std::strerror(errno);
+    throw std::runtime_error(errorMessage);
+  }
+
+  int fileDescriptor = open(path, O_CREAT | O_WRONLY | O_TRUNC, 0600);
+  if (fileDescriptor == -1) {
+    std::string errorMessage = "Failed to open file " + std::string(path) +
+                               ": " + std::strerror(errno);
+    throw std::runtime_error(errorMessage);
+  }
 
   ssize_t bytesWritten =
       write(fileDescriptor, content.c_str(), content.length());
@@ -52,15 +250,16 @@ void ResultsWriter::publishResults(bool evacuation) {
   }
 
   if (close(fileDescriptor) < 0) {
-    std::string errorMessage = "Failed to close file " + std::string(fileName) +
+    std::string errorMessage = "Failed to close file " + std::string(path) +
                                ": " + std::strerror(errno);
     throw std::runtime_error(errorMessage);
   }
 }
 
-void ResultsWriter::calculateScores(bool evacuation) {
-  for (int i = 0; i < SharedMemoryManager::data()->candidateCount; i++) {
-    CandidateInfo *candidate = &SharedMemoryManager::data()->candidates[i];
+void ResultsWriter::calculateScores(CandidateInfo *candidates, int count,
+                                    bool evacuation) {
+  for (int i = 0; i < count; i++) {
+    CandidateInfo *candidate = &candidates[i];
     if (evacuation) {
       bool incomplete =
           candidate->theoreticalScore < 0.0 || candidate->practicalScore < 0.0;
@@ -80,13 +279,14 @@ void ResultsWriter::calculateScores(bool evacuation) {
   }
 }
 
-std::string ResultsWriter::getTableContent(bool evacuation) {
+std::string ResultsWriter::getTableContent(CandidateInfo *candidates,
+                                           int count, bool evacuation) {
   std::string notCompletedContent = "";
   std::string completedContent = "";
-  std::vector<CandidateInfo> candidates;
+  std::vector<CandidateInfo> ranking;
 
-  for (int i = 0; i < SharedMemoryManager::data()->candidateCount; i++) {
-    CandidateInfo *candidate = &SharedMemoryManager::data()->candidates[i];
+  for (int i = 0; i < count; i++) {
+    CandidateInfo *candidate = &candidates[i];
     if (evacuation && candidate->finalScore < 0.0) {
       notCompletedContent +=
           "| " + std::to_string(candidate->pid) + " | " + std::to_string(i) +
@@ -95,16 +295,16 @@ std::string ResultsWriter::getTableContent(bool evacuation) {
           std::to_string(candidate->practicalScore) + " | NIE UKONCZONO |\n";
     } else {
       candidate->index = i;
-      candidates.push_back(*candidate);
+      ranking.push_back(*candidate);
     }
   }
 
-  std::sort(candidates.begin(), candidates.end(),
+  std::sort(ranking.begin(), ranking.end(),
             [](const CandidateInfo &a, const CandidateInfo &b) {
               return a.finalScore > b.finalScore;
             });
 
-  for (const CandidateInfo &candidate : candidates) {
+  for (const CandidateInfo &candidate : ranking) {
     completedContent += "| " + std::to_string(candidate.pid) + " | " +
                         std::to_string(candidate.index) + " | " +
                         (candidate.status != NotEligible ? "TAK" : "NIE") +
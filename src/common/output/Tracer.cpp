@@ -0,0 +1,349 @@
+#include "common/output/Tracer.h"
+
+#include "common/ipc/Namespace.h"
+#include "common/output/ResultsWriter.h"
+#include "common/utils/Time.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifdef TRACING
+namespace {
+
+/**
+ * Escape a string for a JSON string literal.
+ *
+ * @param value The string.
+ * @return The escaped string.
+ */
+std::string escapeJson(const char *value) {
+  std::string escaped;
+  for (const char *c = value; *c != '\0'; c++) {
+    if (*c == '"' || *c == '\\') {
+      escaped += '\\';
+    }
+    escaped += *c;
+  }
+  return escaped;
+}
+
+/**
+ * Format a trace event as a Chrome trace event JSON object.
+ *
+ * @param event The event.
+ * @return The JSON object.
+ */
+std::string eventJson(const TraceEvent &event) {
+  char buffer[256];
+
+  if (event.phase == 'M') {
+    /* Metadata: the category tells whether a process or a thread is named */
+    snprintf(buffer, sizeof(buffer),
+             "{\"name\":\"%s_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,"
+             "\"args\":{\"name\":\"%s\"}}",
+             event.category, event.pid, event.tid,
+             escapeJson(event.name).c_str());
+    return buffer;
+  }
+
+  int length = snprintf(
+      buffer, sizeof(buffer),
+      "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%d,"
+      "\"tid\":%d",
+      escapeJson(event.name).c_str(), escapeJson(event.category).c_str(),
+      event.phase, event.timestamp / 1e3, event.pid, event.tid);
+  std::string json(buffer, length);
+
+  if (event.phase == 'X') {
+    snprintf(buffer, sizeof(buffer), ",\"dur\":%.3f", event.duration / 1e3);
+    json += buffer;
+  } else if (event.phase == 'i') {
+    json += ",\"s\":\"t\"";
+  }
+
+  if (event.arg != -1) {
+    json += ",\"args\":{\"id\":" + std::to_string(event.arg) + "}";
+  }
+
+  return json + "}";
+}
+
+} // namespace
+#endif
+
+/**
+ * Get the tracer instance of the process.
+ *
+ * @return The tracer instance.
+ */
+Tracer &Tracer::shared() {
+  static Tracer instance;
+  return instance;
+}
+
+/**
+ * Constructor for the tracer.
+ */
+Tracer::Tracer() {
+  pthread_mutex_init(&mutex_, nullptr);
+  events_.reserve(bufferSize);
+  directory_ = directory();
+}
+
+/**
+ * Destructor for the tracer. Writes the buffered events at exit, unless the
+ * exit interrupted a thread that holds the tracer.
+ */
+Tracer::~Tracer() {
+  if (pthread_mutex_trylock(&mutex_) == 0) {
+    writeEvents();
+    pthread_mutex_unlock(&mutex_);
+  }
+  pthread_mutex_destroy(&mutex_);
+}
+
+/**
+ * Name the current process in the trace.
+ *
+ * @param name The name of the process.
+ */
+void Tracer::setProcessName([[maybe_unused]] const std::string &name) {
+#ifdef TRACING
+  shared().record('M', "process", name.c_str(), 0, 0, -1);
+#endif
+}
+
+/**
+ * Name the current thread in the trace.
+ *
+ * @param name The name of the thread.
+ */
+void Tracer::setThreadName([[maybe_unused]] const std::string &name) {
+#ifdef TRACING
+  shared().record('M', "thread", name.c_str(), 0, 0, -1);
+#endif
+}
+
+/**
+ * Record the beginning of a span on the current thread.
+ *
+ * @param category The category of the span.
+ * @param name The name of the span.
+ * @param arg The candidate index or pid, -1 if none.
+ */
+void Tracer::begin([[maybe_unused]] const char *category,
+                   [[maybe_unused]] const char *name,
+                   [[maybe_unused]] int arg) {
+#ifdef TRACING
+  shared().record('B', category, name, Time::monotonicNs(), 0, arg);
+#endif
+}
+
+/**
+ * Record the end of a span on the current thread.
+ *
+ * @param category The category of the span.
+ * @param name The name of the span.
+ * @param arg The candidate index or pid, -1 if none.
+ */
+void Tracer::end([[maybe_unused]] const char *category,
+                 [[maybe_unused]] const char *name,
+                 [[maybe_unused]] int arg) {
+#ifdef TRACING
+  shared().record('E', category, name, Time::monotonicNs(), 0, arg);
+#endif
+}
+
+/**
+ * Record a span whose start and end are already known.
+ *
+ * @param category The category of the span.
+ * @param name The name of the span.
+ * @param start The start of the span (monotonic ns).
+ * @param end The end of the span (monotonic ns).
+ * @param arg The candidate index or pid, -1 if none.
+ */
+void Tracer::complete([[maybe_unused]] const char *category,
+                      [[maybe_unused]] const char *name,
+                      [[maybe_unused]] uint64_t start,
+                      [[maybe_unused]] uint64_t end,
+                      [[maybe_unused]] int arg) {
+#ifdef TRACING
+  shared().record('X', category, name, start, end - start, arg);
+#endif
+}
+
+/**
+ * Record an instant event on the current thread.
+ *
+ * @param category The category of the event.
+ * @param name The name of the event.
+ * @param arg The candidate index or pid, -1 if none.
+ */
+void Tracer::instant([[maybe_unused]] const char *category,
+                     [[maybe_unused]] const char *name,
+                     [[maybe_unused]] int arg) {
+#ifdef TRACING
+  shared().record('i', category, name, Time::monotonicNs(), 0, arg);
+#endif
+}
+
+/**
+ * Create the trace directory and remove the buffers of a previous run. Must be
+ * called by the dean before spawning any process.
+ *
+ * @throw std::runtime_error If the directory cannot be created.
+ */
+void Tracer::prepareDirectory() {
+#ifdef TRACING
+  if (mkdir(directory().c_str(), 0755) == -1 && errno != EEXIST) {
+    throw std::runtime_error("Failed to create trace directory: " +
+                             std::string(std::strerror(errno)));
+  }
+
+  DIR *dir = opendir(directory().c_str());
+  if (dir == nullptr) {
+    throw std::runtime_error("Failed to open trace directory: " +
+                             std::string(std::strerror(errno)));
+  }
+
+  while (struct dirent *entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name.size() > 4 && name.compare(name.size() - 4, 4, ".bin") == 0) {
+      unlink((directory() + "/" + name).c_str());
+    }
+  }
+  closedir(dir);
+#endif
+}
+
+/**
+ * Write the buffered events of the process to its trace buffer file.
+ */
+void Tracer::flush() {
+#ifdef TRACING
+  Tracer &tracer = shared();
+  pthread_mutex_lock(&tracer.mutex_);
+  tracer.writeEvents();
+  pthread_mutex_unlock(&tracer.mutex_);
+#endif
+}
+
+/**
+ * Merge the trace buffers of all processes into a Chrome trace JSON file.
+ *
+ * @param path The path of the JSON file.
+ * @throw std::runtime_error If the trace cannot be written.
+ */
+void Tracer::merge([[maybe_unused]] const char *path) {
+#ifdef TRACING
+  DIR *dir = opendir(directory().c_str());
+  if (dir == nullptr) {
+    throw std::runtime_error("Failed to open trace directory: " +
+                             std::string(std::strerror(errno)));
+  }
+
+  std::string content = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  bool first = true;
+
+  while (struct dirent *entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name.size() <= 4 || name.compare(name.size() - 4, 4, ".bin") != 0) {
+      continue;
+    }
+
+    FILE *file = fopen((directory() + "/" + name).c_str(), "rb");
+    if (file == nullptr) {
+      continue;
+    }
+
+    TraceEvent event;
+    while (fread(&event, sizeof(event), 1, file) == 1) {
+      event.category[sizeof(event.category) - 1] = '\0';
+      event.name[sizeof(event.name) - 1] = '\0';
+      content += (first ? "" : ",\n") + eventJson(event);
+      first = false;
+    }
+    fclose(file);
+  }
+  closedir(dir);
+
+  content += "\n]}\n";
+  ResultsWriter::writeFile(path, content);
+#endif
+}
+
+/**
+ * Record an event in the buffer, writing the buffer out when it is full.
+ *
+ * @param phase The Chrome trace event phase.
+ * @param category The category of the event.
+ * @param name The name of the event.
+ * @param timestamp The timestamp of the event (monotonic ns).
+ * @param duration The duration of a complete event (ns).
+ * @param arg The candidate index or pid, -1 if none.
+ */
+void Tracer::record(char phase, const char *category, const char *name,
+                    uint64_t timestamp, uint64_t duration, int arg) {
+  TraceEvent event = {};
+  event.timestamp = timestamp;
+  event.duration = duration;
+  event.pid = getpid();
+  event.tid = static_cast<int32_t>(syscall(SYS_gettid));
+  event.arg = arg;
+  event.phase = phase;
+  strncpy(event.category, category, sizeof(event.category) - 1);
+  strncpy(event.name, name, sizeof(event.name) - 1);
+
+  /* Commission members may be cancelled, never while holding the tracer */
+  int cancelState;
+  pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &cancelState);
+  pthread_mutex_lock(&mutex_);
+
+  events_.push_back(event);
+  if (events_.size() >= bufferSize) {
+    writeEvents();
+  }
+
+  pthread_mutex_unlock(&mutex_);
+  pthread_setcancelstate(cancelState, nullptr);
+}
+
+/**
+ * Append the buffered events to the trace buffer file of the process. Must be
+ * called with the tracer mutex held.
+ */
+void Tracer::writeEvents() {
+  if (events_.empty()) {
+    return;
+  }
+
+  std::string path = directory_ + "/" + std::to_string(getpid()) + ".bin";
+  int fileDescriptor = open(path.c_str(), O_CREAT | O_WRONLY | O_APPEND, 0644);
+  if (fileDescriptor == -1) {
+    perror("Failed to open trace buffer");
+    events_.clear();
+    return;
+  }
+
+  size_t size = events_.size() * sizeof(TraceEvent);
+  if (write(fileDescriptor, events_.data(), size) != (ssize_t)size) {
+    perror("Failed to write trace buffer");
+  }
+  close(fileDescriptor);
+
+  events_.clear();
+}
+
+/**
+ * Get the directory of the trace buffers of the run.
+ *
+ * @return The directory path.
+ */
+std::string Tracer::directory() { return Namespace::outputPath("trace"); }
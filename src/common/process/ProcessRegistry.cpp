@@ -3,63 +3,77 @@
 #include "common/ipc/MutexWrapper.h"
 #include "common/ipc/SharedMemoryManager.h"
 #include "common/output/Logger.h"
+#include <cerrno>
+#include <cstring>
 #include <signal.h>
 
-void ProcessRegistry::registerCommission(pid_t pid, char commission) {
+void ProcessRegistry::registerCommission(pid_t pid, char commission,
+                                         int shard) {
   if (commission == 'A') {
-    SharedMemoryManager::data()->commissionAPID = pid;
+    SharedMemoryManager::data()->commissionAPID[shard] = pid;
   } else {
-    SharedMemoryManager::data()->commissionBID = pid;
+    SharedMemoryManager::data()->commissionBID[shard] = pid;
   }
 }
 
+void ProcessRegistry::registerProcessGroup(pid_t pgid) {
+  SharedMemoryManager::data()->childProcessGroup = pgid;
+}
+
+/* Joins the readiness barrier the dean waits on before starting the exam */
+void ProcessRegistry::markReady() {
+  SharedState *state = SharedMemoryManager::data();
+  MutexWrapper::lock(&state->examStateMutex);
+  state->readyCount++;
+  pthread_cond_broadcast(&state->examStateCond);
+  MutexWrapper::unlock(&state->examStateMutex);
+}
+
 void ProcessRegistry::unregister(pid_t pid) {
-  if (pid == SharedMemoryManager::data()->commissionAPID) {
-    SharedMemoryManager::data()->commissionAPID = -1;
-  } else if (pid == SharedMemoryManager::data()->commissionBID) {
-    SharedMemoryManager::data()->commissionBID = -1;
-  } else {
-    try {
-      pthread_mutex_t *candidatesMutex =
-          &SharedMemoryManager::data()->candidateMutex;
-      MutexWrapper::lock(candidatesMutex);
+  SharedState *state = SharedMemoryManager::data();
+  for (int shard = 0; shard < maxCommissionShards; shard++) {
+    if (pid == state->commissionAPID[shard]) {
+      state->commissionAPID[shard] = -1;
+      return;
+    }
+    if (pid == state->commissionBID[shard]) {
+      state->commissionBID[shard] = -1;
+      return;
+    }
+  }
 
-      for (int i = 0; i < SharedMemoryManager::data()->candidateCount; i++) {
-        if (SharedMemoryManager::data()->candidates[i].pid == pid) {
-          SharedMemoryManager::data()->candidates[i].status = Terminated;
-          MutexWrapper::unlock(candidatesMutex);
-          return;
-        }
+  try {
+    pthread_mutex_t *candidatesMutex =
+        &SharedMemoryManager::data()->candidateMutex;
+    MutexWrapper::lock(candidatesMutex);
+
+    for (int i = 0; i < SharedMemoryManager::data()->candidateCount; i++) {
+      if (SharedMemoryManager::data()->candidates[i].pid == pid) {
+        SharedMemoryManager::data()->candidates[i].exited = true;
+        MutexWrapper::unlock(candidatesMutex);
+        return;
       }
-      
-      MutexWrapper::unlock(candidatesMutex);
-    } catch (const std::exception &e) {
-      std::string errorMessage = "Failed to unregister process " +
-                                 std::to_string(pid) + ": " +
-                                 std::string(e.what());
-      perror(errorMessage.c_str());
     }
-
-    Logger::error("Candidate process with PID:" + std::to_string(pid) +
-                  " not found");
+    MutexWrapper::unlock(candidatesMutex);
+  } catch (const std::exception &e) {
+    std::string errorMessage = "Failed to unregister process " +
+                               std::to_string(pid) + ": " +
+                               std::string(e.what());
+    perror(errorMessage.c_str());
   }
+
+  Logger::error("Candidate process with PID:" + std::to_string(pid) +
+                " not found");
 }
 
 void ProcessRegistry::propagateSignal(int signal) {
   Logger::info("Propagating signal: " + std::to_string(signal) +
                " to all processes");
 
-  if (SharedMemoryManager::data()->commissionAPID != -1) {
-    kill(SharedMemoryManager::data()->commissionAPID, signal);
-  }
-
-  if (SharedMemoryManager::data()->commissionBID != -1) {
-    kill(SharedMemoryManager::data()->commissionBID, signal);
-  }
-
-  for (int i = 0; i < SharedMemoryManager::data()->candidateCount; i++) {
-    if (SharedMemoryManager::data()->candidates[i].status != Terminated) {
-      kill(SharedMemoryManager::data()->candidates[i].pid, signal);
-    }
+  /* All children share a single process group, the dean is not part of it */
+  pid_t pgid = SharedMemoryManager::data()->childProcessGroup;
+  if (pgid > 0 && killpg(pgid, signal) == -1 && errno != ESRCH) {
+    Logger::warn("Failed to signal process group " + std::to_string(pgid) +
+                 ": " + std::string(strerror(errno)));
   }
 }
@@ -1,27 +1,115 @@
 #include "common/utils/Memory.h"
 
 #include "common/ipc/SharedMemoryManager.h"
+#include "common/ipc/SeatScheduler.h"
 #include "common/output/Logger.h"
+#include <cerrno>
 #include <cstring>
 #include <string>
 #include <stdexcept>
 
-void Memory::resetSeat(char commission, size_t seat) {
-  if (seat >= 3) {
+CommissionInfo *Memory::commission(char commission, int shard) {
+  SharedState *state = SharedMemoryManager::data();
+  return commission == 'A' ? &state->commissionA[shard]
+                           : &state->commissionB[shard];
+}
+
+pthread_mutex_t *Memory::commissionMutex(char commission, int shard) {
+  SharedState *state = SharedMemoryManager::data();
+  return commission == 'A' ? &state->commissionAMutex[shard]
+                           : &state->commissionBMutex[shard];
+}
+
+void Memory::resetSeat(char commission, int shard, size_t seat) {
+  CommissionInfo *commissionInfo = Memory::commission(commission, shard);
+  if (seat >= static_cast<size_t>(commissionInfo->seatCount)) {
     Logger::warn("Tried to reset invalid seat with index: " +
                  std::to_string(seat));
     return;
   }
 
-  if (commission == 'A') {
-    SharedMemoryManager::data()->commissionA.seats[seat].pid = -1;
-    SharedMemoryManager::data()->commissionA.seats[seat].questionsCount = 0;
-    SharedMemoryManager::data()->commissionA.seats[seat].answered = false;
-  } else if (commission == 'B') {
-    SharedMemoryManager::data()->commissionB.seats[seat].pid = -1;
-    SharedMemoryManager::data()->commissionB.seats[seat].questionsCount = 0;
-    SharedMemoryManager::data()->commissionB.seats[seat].answered = false;
+  if (commissionInfo->seat(seat).pid > 0) {
+    SharedMemoryManager::data()
+        ->metrics.commissions[commission == 'A' ? 0 : 1]
+        .seatsBusy--;
+    commissionInfo->load--;
   }
+
+  commissionInfo->seat(seat) = CommissionSeat();
+}
+
+void Memory::initializeCandidates() {
+  SharedState *state = SharedMemoryManager::data();
+
+  for (int i = 0; i < state->candidateCount; i++) {
+    CandidateInfo &candidate = state->candidates[i];
+    candidate.queuePrev = -1;
+    candidate.queueNext = -1;
+    candidate.assignedSeat = -1;
+    if (sem_init(&candidate.seatReady, 1, 0) == -1) {
+      throw std::runtime_error("Failed to initialize seat semaphore: " +
+                               std::string(std::strerror(errno)));
+    }
+  }
+}
+
+/* The seats follow the candidates, shard by shard, those of commission A
+ * first; the question tasks follow all the seats in the same order */
+void Memory::initializeCommissions(const CommissionSize &sizeA,
+                                   const CommissionSize &sizeB) {
+  SharedState *state = SharedMemoryManager::data();
+  CommissionSeat *seats = reinterpret_cast<CommissionSeat *>(
+      &state->candidates[state->candidateCount]);
+
+  /* Every slot the autoscaler may use gets its seats up front */
+  state->commissionAShardCount = sizeA.maxShardCount;
+  state->commissionBShardCount = sizeB.maxShardCount;
+  state->commissionAActiveShards = sizeA.shardCount;
+  state->commissionBActiveShards = sizeB.shardCount;
+
+  auto layout = [&](char commission, const CommissionSize &size) {
+    for (int shard = 0; shard < size.maxShardCount; shard++) {
+      CommissionInfo *info = Memory::commission(commission, shard);
+      info->seatCount = size.seatCount;
+      info->memberCount = size.memberCount;
+      info->fullMask = (1 << size.memberCount) - 1;
+      info->seatsOffset = reinterpret_cast<char *>(seats) -
+                          reinterpret_cast<char *>(info);
+      info->load = 0;
+      info->active = shard < size.shardCount;
+      info->retiring = false;
+      info->queueHead = -1;
+      info->queueTail = -1;
+      seats += size.seatCount;
+
+      for (int i = 0; i < size.seatCount; i++) {
+        resetSeat(commission, shard, i);
+      }
+    }
+  };
+
+  layout('A', sizeA);
+  layout('B', sizeB);
+
+  QuestionTask *tasks = reinterpret_cast<QuestionTask *>(seats);
+  auto layoutTasks = [&](char commission, const CommissionSize &size) {
+    for (int shard = 0; shard < size.maxShardCount; shard++) {
+      CommissionInfo *info = Memory::commission(commission, shard);
+      info->tasksOffset = reinterpret_cast<char *>(tasks) -
+                          reinterpret_cast<char *>(info);
+      for (int member = 0; member < maxCommissionMembers; member++) {
+        info->taskHead[member] = -1;
+        info->taskTail[member] = -1;
+      }
+      for (int i = 0; i < size.seatCount * size.memberCount; i++) {
+        tasks[i] = QuestionTask();
+      }
+      tasks += size.seatCount * size.memberCount;
+    }
+  };
+
+  layoutTasks('A', sizeA);
+  layoutTasks('B', sizeB);
 }
 
 void Memory::initializeMutex() {
@@ -51,8 +139,10 @@ void Memory::initializeMutex() {
   };
 
   initMutex(&state->candidateMutex, "candidate");
-  initMutex(&state->commissionAMutex, "commissionA");
-  initMutex(&state->commissionBMutex, "commissionB");
+  for (int shard = 0; shard < maxCommissionShards; shard++) {
+    initMutex(&state->commissionAMutex[shard], "commissionA");
+    initMutex(&state->commissionBMutex[shard], "commissionB");
+  }
   initMutex(&state->examStateMutex, "examState");
 
   result = pthread_mutexattr_destroy(&attr);
@@ -62,11 +152,41 @@ void Memory::initializeMutex() {
   }
 }
 
-CandidateInfo *Memory::findCandidate(char commissionType, int seat) {
+void Memory::initializeCondition() {
+  pthread_condattr_t attr;
+  int result = pthread_condattr_init(&attr);
+  if (result != 0) {
+    throw std::runtime_error("Failed to initialize condition attributes: " +
+                             std::string(std::strerror(result)));
+  }
+
+  /* Shared between processes, timed waits use the monotonic clock */
+  result = pthread_condattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+  if (result == 0) {
+    result = pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  }
+  if (result == 0) {
+    result = pthread_cond_init(&SharedMemoryManager::data()->examStateCond,
+                               &attr);
+  }
+  for (int shard = 0; shard < maxCommissionShards && result == 0; shard++) {
+    result = pthread_cond_init(&commission('A', shard)->tasksReady, &attr);
+    if (result == 0) {
+      result = pthread_cond_init(&commission('B', shard)->tasksReady, &attr);
+    }
+  }
+  pthread_condattr_destroy(&attr);
+
+  if (result != 0) {
+    throw std::runtime_error("Failed to initialize condition variables: " +
+                             std::string(std::strerror(result)));
+  }
+}
+
+CandidateInfo *Memory::findCandidate(char commissionType, int shard,
+                                     int seat) {
   SharedState *state = SharedMemoryManager::data();
-  CommissionInfo *commission =
-      commissionType == 'A' ? &state->commissionA : &state->commissionB;
-  int pid = commission->seats[seat].pid;
+  int pid = commission(commissionType, shard)->seat(seat).pid;
 
   for (int i = 0; i < state->candidateCount; i++) {
     if (state->candidates[i].pid == pid) {
@@ -78,4 +198,147 @@ CandidateInfo *Memory::findCandidate(char commissionType, int seat) {
                " with pid " + std::to_string(pid) +
                " - candidate may have already exited");
   return nullptr;
-}
\ No newline at end of file
+}
+
+/* The queue links the waiting candidates through their CandidateInfo; must be
+ * called with the shard mutex held */
+void Memory::enqueue(char commission, int shard, int index) {
+  CommissionInfo *info = Memory::commission(commission, shard);
+  CandidateInfo *candidates = SharedMemoryManager::data()->candidates;
+
+  candidates[index].queuePrev = info->queueTail;
+  candidates[index].queueNext = -1;
+  if (info->queueTail == -1) {
+    info->queueHead = index;
+  } else {
+    candidates[info->queueTail].queueNext = index;
+  }
+  info->queueTail = index;
+}
+
+/* Must be called with the shard mutex held */
+void Memory::dequeue(char commission, int shard, int index) {
+  CommissionInfo *info = Memory::commission(commission, shard);
+  CandidateInfo *candidates = SharedMemoryManager::data()->candidates;
+  CandidateInfo &candidate = candidates[index];
+
+  if (candidate.queuePrev == -1) {
+    info->queueHead = candidate.queueNext;
+  } else {
+    candidates[candidate.queuePrev].queueNext = candidate.queueNext;
+  }
+  if (candidate.queueNext == -1) {
+    info->queueTail = candidate.queuePrev;
+  } else {
+    candidates[candidate.queueNext].queuePrev = candidate.queuePrev;
+  }
+  candidate.queuePrev = -1;
+  candidate.queueNext = -1;
+}
+
+/* Queues the question of every member for a taken seat and wakes the
+ * members; must be called with the shard mutex held */
+void Memory::enqueueQuestions(char commission, int shard, int seat) {
+  CommissionInfo *info = Memory::commission(commission, shard);
+
+  for (int member = 0; member < info->memberCount; member++) {
+    /* Still queued for a previous candidate, asks the current one */
+    QuestionTask &task = info->task(seat, member);
+    if (task.queued) {
+      continue;
+    }
+
+    task.queued = true;
+    task.next = -1;
+    if (info->taskTail[member] == -1) {
+      info->taskHead[member] = seat;
+    } else {
+      info->task(info->taskTail[member], member).next = seat;
+    }
+    info->taskTail[member] = seat;
+  }
+
+  int result = pthread_cond_broadcast(&info->tasksReady);
+  if (result != 0) {
+    throw std::runtime_error("Failed to signal question tasks: " +
+                             std::string(std::strerror(result)));
+  }
+}
+
+/* Takes the oldest question task of a member, returning its seat or -1;
+ * must be called with the shard mutex held */
+int Memory::takeQuestion(char commission, int shard, int member) {
+  CommissionInfo *info = Memory::commission(commission, shard);
+  int seat = info->taskHead[member];
+  if (seat == -1) {
+    return -1;
+  }
+
+  QuestionTask &task = info->task(seat, member);
+  info->taskHead[member] = task.next;
+  if (task.next == -1) {
+    info->taskTail[member] = -1;
+  }
+  task = QuestionTask();
+  return seat;
+}
+
+/* Gives a free seat to the waiting candidate chosen by the seat policy and
+ * wakes only that candidate; must be called with the shard mutex held */
+bool Memory::handOffSeat(char commission, int shard, int seat) {
+  CommissionInfo *info = Memory::commission(commission, shard);
+  CandidateInfo *candidates = SharedMemoryManager::data()->candidates;
+
+  for (int index = SeatScheduler::select(commission, shard); index != -1;
+       index = SeatScheduler::select(commission, shard)) {
+    CandidateInfo &candidate = candidates[index];
+    dequeue(commission, shard, index);
+
+    /* Terminated while waiting, nobody would take the seat */
+    if (candidate.exited) {
+      info->load--;
+      continue;
+    }
+
+    CommissionSeat &taken = info->seat(seat);
+    taken.pid = candidate.pid;
+    taken.questionsCount = 0;
+    taken.answered = false;
+    enqueueQuestions(commission, shard, seat);
+    SharedMemoryManager::data()
+        ->metrics.commissions[commission == 'A' ? 0 : 1]
+        .seatsBusy++;
+    candidate.assignedSeat = seat;
+    if (sem_post(&candidate.seatReady) == -1) {
+      throw std::runtime_error("Failed to post seat semaphore: " +
+                               std::string(std::strerror(errno)));
+    }
+    return true;
+  }
+
+  return false;
+}
+
+/* Must be called with the candidate mutex held, inside a write section of
+ * scoreSequence */
+void Memory::setStatus(CandidateInfo *candidate, CandidateStatus status) {
+  LiveMetrics &metrics = SharedMemoryManager::data()->metrics;
+  metrics.statusCounts[candidate->status]--;
+  metrics.statusCounts[status]++;
+  candidate->status = status;
+}
+
+/* Copies the scores and the status of a candidate without the candidate
+ * mutex, repeating the copy while a writer updates them */
+CandidateScores Memory::readScores(const CandidateInfo *candidate) {
+  CandidateScores scores;
+  unsigned start;
+
+  do {
+    start = candidate->scoreSequence.beginRead();
+    scores = {candidate->theoreticalScore, candidate->practicalScore,
+              candidate->finalScore, candidate->status};
+  } while (candidate->scoreSequence.retryRead(start));
+
+  return scores;
+}
@@ -2,18 +2,37 @@
 
 #include <random>
 
+namespace {
+
+/**
+ * Get the random engine of the calling thread. The engine is seeded once from
+ * std::random_device unless Random::seed() is called.
+ *
+ * @return The random engine.
+ */
+std::mt19937 &engine() {
+  static thread_local std::mt19937 gen(std::random_device{}());
+  return gen;
+}
+
+} // namespace
+
+/**
+ * Seed the random engine of the calling thread, making the following draws
+ * reproducible.
+ *
+ * @param value The seed.
+ */
+void Random::seed(unsigned int value) { engine().seed(value); }
+
 double Random::randomDouble(double min, double max) {
-  std::random_device rd;
-  std::mt19937 gen(rd());
   std::uniform_real_distribution<> dist(min, max);
-  return dist(gen);
+  return dist(engine());
 }
 
 int Random::randomInt(int min, int max) {
-  std::random_device rd;
-  std::mt19937 gen(rd());
   std::uniform_int_distribution<> dist(min, max);
-  return dist(gen);
+  return dist(engine());
 }
 
 double Random::sampleMean(int samples, double min, double max) {
@@ -0,0 +1,56 @@
+#include "common/utils/Stats.h"
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * Calculate the arithmetic mean of the values.
+ *
+ * @param values The values.
+ * @return The mean, or 0.0 if there are no values.
+ */
+double Stats::mean(const std::vector<double> &values) {
+  if (values.empty()) {
+    return 0.0;
+  }
+
+  double sum = 0.0;
+  for (double value : values) {
+    sum += value;
+  }
+
+  return sum / values.size();
+}
+
+/**
+ * Calculate the percentile of the values (nearest-rank method).
+ *
+ * @param values The values.
+ * @param percent The percentile in range [0, 100].
+ * @return The percentile, or 0.0 if there are no values.
+ */
+double Stats::percentile(std::vector<double> values, double percent) {
+  if (values.empty()) {
+    return 0.0;
+  }
+
+  size_t rank = static_cast<size_t>(std::ceil(percent / 100.0 * values.size()));
+  size_t index = rank == 0 ? 0 : std::min(rank, values.size()) - 1;
+
+  std::nth_element(values.begin(), values.begin() + index, values.end());
+  return values[index];
+}
+
+/**
+ * Get the maximum of the values.
+ *
+ * @param values The values.
+ * @return The maximum, or 0.0 if there are no values.
+ */
+double Stats::max(const std::vector<double> &values) {
+  if (values.empty()) {
+    return 0.0;
+  }
+
+  return *std::max_element(values.begin(), values.end());
+}
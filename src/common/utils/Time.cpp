@@ -16,3 +16,14 @@ int Time::now() {
   std::tm *local = std::localtime(&now);
   return local->tm_hour * 3600 + local->tm_min * 60 + local->tm_sec;
 }
+
+/**
+ * Get the monotonic clock time, comparable between processes.
+ *
+ * @return The time in nanoseconds.
+ */
+uint64_t Time::monotonicNs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
@@ -0,0 +1,74 @@
+#include "dean/Autoscaler.h"
+
+#include <cstdio>
+
+/**
+ * Constructor for the autoscaler.
+ *
+ * @param threshold The number of waiters per open shard above which a shard
+ * is added.
+ * @param idleSamples The number of consecutive samples with an empty queue
+ * after which an elastic shard is retired.
+ */
+Autoscaler::Autoscaler(int threshold, int idleSamples)
+    : threshold_(threshold), idleSamples_(idleSamples) {}
+
+/**
+ * Decides whether to add or retire a shard of a commission type.
+ *
+ * @param commission The index of the commission (0 for A, 1 for B).
+ * @param queued The number of candidates waiting for a seat.
+ * @param openShards The number of shards open to candidates.
+ * @param minShards The number of shards started with the exam, never retired.
+ * @param maxShards The maximum number of shards.
+ * @return The action to take.
+ */
+ScalingAction Autoscaler::decide(int commission, int queued, int openShards,
+                                 int minShards, int maxShards) {
+  idle_[commission] = queued > 0 ? 0 : idle_[commission] + 1;
+
+  if (queued > threshold_ * openShards && openShards < maxShards) {
+    return SpawnShard;
+  }
+
+  if (idle_[commission] >= idleSamples_ && openShards > minShards) {
+    idle_[commission] = 0;
+    return RetireShard;
+  }
+
+  return KeepShards;
+}
+
+/**
+ * Records a spawn or retire event for the report.
+ *
+ * @param event The event.
+ */
+void Autoscaler::record(const ScalingEvent &event) { events_.push_back(event); }
+
+/**
+ * Get the spawn and retire events.
+ *
+ * @param startNs The start of the exam, the events are reported relative to it.
+ * @return The report formatted as a table.
+ */
+std::string Autoscaler::getTableContent(uint64_t startNs) const {
+  std::string content = "\n| ==== Autoskalowanie komisji ==== |\n";
+  content += "| Czas [s] | Komisja | Shard | Zdarzenie | Kolejka | Otwarte "
+             "shardy |\n";
+  content += "|----------|---------|-------|-----------|---------|---------"
+             "------|\n";
+
+  for (const ScalingEvent &event : events_) {
+    double time = event.timeNs > startNs ? (event.timeNs - startNs) / 1e9 : 0.0;
+
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "| %.3f | %c | %d | %s | %d | %d |\n",
+             time, event.commission, event.shard,
+             event.action == SpawnShard ? "uruchomienie" : "wycofanie",
+             event.queued, event.openShards);
+    content += buffer;
+  }
+
+  return content;
+}
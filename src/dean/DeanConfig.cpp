@@ -5,10 +5,11 @@
 
 DeanConfig::DeanConfig()
     : placeCount(0), startTime(0), candidateCount(0), failedExamCount(0),
-      retakeExamCount(0), timesA{0.0, 0.0, 0.0, 0.0, 0.0},
-      timesB{0.0, 0.0, 0.0} {}
+      retakeExamCount(0), sizeA{0, 0, 0, 0}, sizeB{0, 0, 0, 0} {}
 
-DeanConfig::DeanConfig(int places, int startTime) {
+DeanConfig::DeanConfig(int places, int startTime, CommissionSize sizeA,
+                       CommissionSize sizeB)
+    : sizeA(sizeA), sizeB(sizeB) {
   Logger::info("DeanConfig initialized with: " + std::to_string(places) +
                " places and start time of: " + std::to_string(startTime));
 
@@ -31,16 +32,14 @@ DeanConfig::DeanConfig(int places, int startTime) {
   retakeExamCount = retakeExamRate * candidateCount / 100;
 
   // Times for answers in commission A
-  timesA[0] = Random::randomDouble(0.25, 1.0);
-  timesA[1] = Random::randomDouble(0.25, 1.0);
-  timesA[2] = Random::randomDouble(0.25, 1.0);
-  timesA[3] = Random::randomDouble(0.25, 1.0);
-  timesA[4] = Random::randomDouble(0.25, 1.0);
+  for (int i = 0; i < sizeA.memberCount; i++) {
+    timesA.push_back(Random::randomDouble(0.25, 1.0));
+  }
 
   // Times for answers in commission B
-  timesB[0] = Random::randomDouble(0.25, 1.0);
-  timesB[1] = Random::randomDouble(0.25, 1.0);
-  timesB[2] = Random::randomDouble(0.25, 1.0);
+  for (int i = 0; i < sizeB.memberCount; i++) {
+    timesB.push_back(Random::randomDouble(0.25, 1.0));
+  }
 
   printConfig();
 }
@@ -55,11 +54,33 @@ void DeanConfig::printConfig() {
                std::to_string(failedExamCount) + " failed exams");
   Logger::info("DeanConfig - retake exam count: " +
                std::to_string(retakeExamCount) + " retake exams");
+  Logger::info("DeanConfig - commission A: " +
+               std::to_string(sizeA.shardCount) + " shards (up to " +
+               std::to_string(sizeA.maxShardCount) + "), " +
+               std::to_string(sizeA.seatCount) + " seats, " +
+               std::to_string(sizeA.memberCount) + " members");
+  Logger::info("DeanConfig - commission B: " +
+               std::to_string(sizeB.shardCount) + " shards (up to " +
+               std::to_string(sizeB.maxShardCount) + "), " +
+               std::to_string(sizeB.seatCount) + " seats, " +
+               std::to_string(sizeB.memberCount) + " members");
   Logger::info("DeanConfig - times for answers in commission A: " +
-               std::to_string(timesA[0]) + ", " + std::to_string(timesA[1]) +
-               ", " + std::to_string(timesA[2]) + ", " +
-               std::to_string(timesA[3]) + ", " + std::to_string(timesA[4]));
+               join(timesA));
   Logger::info("DeanConfig - times for answers in commission B: " +
-               std::to_string(timesB[0]) + ", " + std::to_string(timesB[1]) +
-               ", " + std::to_string(timesB[2]));
+               join(timesB));
+}
+
+/**
+ * Joins the answer times of a commission with commas, the format expected by
+ * the candidate.
+ *
+ * @param times The answer times.
+ * @return The joined times.
+ */
+std::string DeanConfig::join(const std::vector<double> &times) {
+  std::string joined;
+  for (size_t i = 0; i < times.size(); i++) {
+    joined += (i > 0 ? "," : "") + std::to_string(times[i]);
+  }
+  return joined;
 }
\ No newline at end of file
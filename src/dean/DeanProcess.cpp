@@ -1,10 +1,13 @@
 #include "dean/DeanProcess.h"
 
 #include "common/ipc/MutexWrapper.h"
+#include "common/ipc/Namespace.h"
+#include "common/ipc/SeatScheduler.h"
 #include "common/ipc/SemaphoreManager.h"
 #include "common/ipc/SharedMemoryManager.h"
 #include "common/output/Logger.h"
 #include "common/output/ResultsWriter.h"
+#include "common/output/Tracer.h"
 #include "common/process/ProcessRegistry.h"
 #include "common/utils/Memory.h"
 #include "common/utils/Misc.h"
@@ -13,10 +16,15 @@
 #include <algorithm>
 #include <atomic>
 #include <cerrno>
+#include <cstring>
+#include <numeric>
 #include <pthread.h>
 #include <regex>
+#include <poll.h>
 #include <signal.h>
+#include <sys/eventfd.h>
 #include <sys/resource.h>
+#include <sys/signalfd.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
@@ -32,6 +40,14 @@ DeanProcess::DeanProcess(int argc, char *argv[])
     handleError("Failed to initialize childPidsMutex");
   }
 
+  pthread_condattr_t condAttr;
+  pthread_condattr_init(&condAttr);
+  pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC);
+  if (pthread_cond_init(&childReapedCond, &condAttr) != 0) {
+    handleError("Failed to initialize childReapedCond");
+  }
+  pthread_condattr_destroy(&condAttr);
+
   try {
     validateArguments(argc, argv);
   } catch (const std::exception &e) {
@@ -55,6 +71,7 @@ DeanProcess::DeanProcess(int argc, char *argv[])
 
 DeanProcess::~DeanProcess() {
   stopCleanupThread();
+  pthread_cond_destroy(&childReapedCond);
   pthread_mutex_destroy(&childPidsMutex);
 }
 
@@ -67,10 +84,129 @@ DeanProcess::~DeanProcess() {
  * @throws std::invalid_argument If the arguments are invalid.
  */
 void DeanProcess::validateArguments(int argc, char *argv[]) {
+  const char *usage = "Invalid number of arguments. Usage: ./dean [-s seats "
+                      "A[:B]] [-a members A] [-b members B] [-n shards A[:B]] "
+                      "[-m least|hash] [-e max shards A[:B]] [-q waiters] "
+                      "[-p fifo|sjf|retake|random] [-j] [-o] "
+                      "<place count> [start time] [seed]";
+
+  /* Validate commission sizes */
+  /* Expected format: -s integer[:integer], -a integer, -b integer, */
+  /* -n integer[:integer], -m least|hash, -e integer[:integer], -q integer, */
+  /* -p fifo|sjf|retake|random, -j, -o */
+  CommissionSize sizeA = {CommissionA::defaultSeatCount,
+                          CommissionA::defaultMemberCount,
+                          CommissionA::defaultShardCount, 0};
+  CommissionSize sizeB = {CommissionB::defaultSeatCount,
+                          CommissionB::defaultMemberCount,
+                          CommissionB::defaultShardCount, 0};
+  int scalingThreshold = 0;
+
+  /* A single value applies to both commissions */
+  auto parsePair = [](const std::string &value, int &a, int &b) {
+    size_t colon = value.find(':');
+    a = std::stoi(value.substr(0, colon));
+    b = colon == std::string::npos ? a : std::stoi(value.substr(colon + 1));
+  };
+
+  int option;
+  while ((option = getopt(argc, argv, "s:a:b:n:m:e:q:p:jo")) != -1) {
+    switch (option) {
+    case 's':
+      parsePair(optarg, sizeA.seatCount, sizeB.seatCount);
+      break;
+    case 'a':
+      sizeA.memberCount = std::stoi(optarg);
+      break;
+    case 'b':
+      sizeB.memberCount = std::stoi(optarg);
+      break;
+    case 'n':
+      parsePair(optarg, sizeA.shardCount, sizeB.shardCount);
+      break;
+    case 'm':
+      if (std::strcmp(optarg, "least") == 0) {
+        shardAssignment = LeastLoadedAssignment;
+      } else if (std::strcmp(optarg, "hash") == 0) {
+        shardAssignment = IndexHashAssignment;
+      } else {
+        throw std::invalid_argument(
+            "Invalid shard assignment. Expected: least or hash");
+      }
+      break;
+    case 'e':
+      parsePair(optarg, sizeA.maxShardCount, sizeB.maxShardCount);
+      break;
+    case 'q':
+      scalingThreshold = std::stoi(optarg);
+      if (scalingThreshold <= 0) {
+        throw std::invalid_argument(
+            "Invalid scaling threshold. Expected: 0 < n");
+      }
+      break;
+    case 'p':
+      seatPolicy = SeatScheduler::parse(optarg);
+      break;
+    case 'j':
+      perCandidateTimes = true;
+      break;
+    case 'o':
+      pipelinedAnswers = true;
+      break;
+    default:
+      throw std::invalid_argument(usage);
+    }
+  }
+
+  /* Expected value: 0 < n <= maxSeatCount */
+  if (sizeA.seatCount <= 0 || sizeA.seatCount > maxSeatCount ||
+      sizeB.seatCount <= 0 || sizeB.seatCount > maxSeatCount) {
+    throw std::invalid_argument("Invalid seat count. Expected: 0 < n <= " +
+                                std::to_string(maxSeatCount));
+  }
+
+  /* Members are stored as bits of the questions mask */
+  /* Expected value: 0 < n <= maxMemberCount */
+  if (sizeA.memberCount <= 0 || sizeA.memberCount > maxMemberCount ||
+      sizeB.memberCount <= 0 || sizeB.memberCount > maxMemberCount) {
+    throw std::invalid_argument("Invalid member count. Expected: 0 < n <= " +
+                                std::to_string(maxMemberCount));
+  }
+
+  /* Expected value: 0 < n <= maxCommissionShards */
+  if (sizeA.shardCount <= 0 || sizeA.shardCount > maxCommissionShards ||
+      sizeB.shardCount <= 0 || sizeB.shardCount > maxCommissionShards) {
+    throw std::invalid_argument("Invalid shard count. Expected: 0 < n <= " +
+                                std::to_string(maxCommissionShards));
+  }
+
+  /* Without -e the shard count is fixed */
+  /* Expected value: shard count <= n <= maxCommissionShards */
+  for (CommissionSize *size : {&sizeA, &sizeB}) {
+    if (size->maxShardCount == 0) {
+      size->maxShardCount = size->shardCount;
+    }
+    if (size->maxShardCount < size->shardCount ||
+        size->maxShardCount > maxCommissionShards) {
+      throw std::invalid_argument(
+          "Invalid maximum shard count. Expected: shard count <= n <= " +
+          std::to_string(maxCommissionShards));
+    }
+  }
+
+  /* By default a shard is added once more candidates wait than one shard
+   * seats */
+  autoscaler = Autoscaler(scalingThreshold > 0
+                              ? scalingThreshold
+                              : std::min(sizeA.seatCount, sizeB.seatCount));
+
+  /* The positional arguments follow the options */
+  argc -= optind - 1;
+  argv += optind - 1;
+
   /* Validate argument count */
-  if (argc != 3) {
-    throw std::invalid_argument("Invalid number of arguments. Usage: ./dean "
-                                "<place count> <start time>");
+  if (argc < 2 || argc > 4) {
+    throw std::invalid_argument(usage);
   }
 
   /* Get maximum possible process count */
@@ -101,22 +237,39 @@ void DeanProcess::validateArguments(int argc, char *argv[]) {
   }
 
   /* Validate start time */
-  /* Expected format: HH:MM (24 hrs) */
+  /* Expected format: HH:MM (24 hrs), optional */
   /* Expected value: correct time, >= current time */
+  /* Without a start time the exam starts as soon as everyone is ready */
+  int seconds = Time::now();
+  int seedIndex = 2;
   std::regex timeRegex("^([01][0-9]|2[0-3]):[0-5][0-9]$");
-  if (!std::regex_match(argv[2], timeRegex)) {
-    throw std::invalid_argument("Start time is invalid or has an invalid "
-                                "format. Expected format: HH:MM (24 hrs)");
+  if (argc > 2 && (argc == 4 || std::strchr(argv[2], ':') != nullptr)) {
+    if (!std::regex_match(argv[2], timeRegex)) {
+      throw std::invalid_argument("Start time is invalid or has an invalid "
+                                  "format. Expected format: HH:MM (24 hrs)");
+    }
+
+    /* Add 59 seconds to make the start time as late as possible */
+    seconds = Time::seconds(argv[2]) + 59;
+    if (seconds < Time::now()) {
+      throw std::invalid_argument("Start time is in the past");
+    }
+    seedIndex = 3;
   }
 
-  /* Add 59 seconds to make the start time as late as possible */
-  int seconds = Time::seconds(argv[2]) + 59;
-  if (seconds < Time::now()) {
-    throw std::invalid_argument("Start time is in the past");
+  /* Validate seed */
+  /* Expected format: unsigned integer */
+  if (argc > seedIndex) {
+    if (!std::regex_match(argv[seedIndex], std::regex("^[0-9]+$"))) {
+      throw std::invalid_argument("Seed must be a non-negative integer");
+    }
+    seed = static_cast<unsigned int>(std::stoul(argv[seedIndex]));
+    seeded = true;
+    Random::seed(seed);
   }
 
   /* Initialize the dean proces configuration */
-  config = DeanConfig(placeCount, seconds);
+  config = DeanConfig(placeCount, seconds, sizeA, sizeB);
 }
 
 /**
@@ -130,20 +283,39 @@ void DeanProcess::initialize() {
     /* Create shared memory and initialize its state */
     /* No mutex because dean is only process that writes to shared memory as of
      * now */
-    SharedMemoryManager::initialize(config.candidateCount);
+    SharedMemoryManager::initialize(
+        config.candidateCount,
+        config.sizeA.seatCount * config.sizeA.maxShardCount +
+            config.sizeB.seatCount * config.sizeB.maxShardCount,
+        config.sizeA.seatCount * config.sizeA.memberCount *
+                config.sizeA.maxShardCount +
+            config.sizeB.seatCount * config.sizeB.memberCount *
+                config.sizeB.maxShardCount);
     SharedMemoryManager::data()->candidateCount = config.candidateCount;
-    for (int i = 0; i < 3; i++) {
-      Memory::resetSeat('A', i);
-      Memory::resetSeat('B', i);
-    }
+    SharedMemoryManager::data()->deanPID = pid_;
+    SharedMemoryManager::data()->seeded = seeded;
+    SharedMemoryManager::data()->randomSeed = seed;
+    SharedMemoryManager::data()->metrics.statusCounts[Pending] =
+        config.candidateCount;
+    SharedMemoryManager::data()->shardAssignment = shardAssignment;
+    SharedMemoryManager::data()->seatPolicy = seatPolicy;
+    SharedMemoryManager::data()->pipelinedAnswers = pipelinedAnswers;
+    Logger::info(std::string("Seat policy: ") + SeatScheduler::name(seatPolicy) +
+                 (perCandidateTimes ? ", answer times drawn per candidate"
+                                    : "") +
+                 (pipelinedAnswers ? ", pipelined answers" : ""));
+    Memory::initializeCandidates();
+    Memory::initializeCommissions(config.sizeA, config.sizeB);
 
     /* Initialize mutexes*/
     Memory::initializeMutex();
+    Memory::initializeCondition();
+
+    SemaphoreManager::create(Namespace::ipcName("logger"), 1);
 
-    /* Create semaphores for commissions */
-    SemaphoreManager::create("commissionA", 0);
-    SemaphoreManager::create("commissionB", 0);
-    SemaphoreManager::create("logger", 1);
+    /* Remove the trace buffers of a previous run */
+    Tracer::prepareDirectory();
+    Tracer::setProcessName("dean");
   } catch (const std::exception &e) {
     std::string errorMessage =
         "Failed to initialize mutex for shared memory: " +
@@ -153,18 +325,36 @@ void DeanProcess::initialize() {
 }
 
 /**
- * Sets up signal handlers for the dean process.
+ * Sets up the signal handling of the dean process. The termination signals
+ * (SIGINT, SIGTERM, SIGQUIT) and the evacuation signal (SIGUSR1) get no
+ * handler: they are blocked in every thread and read by the cleanup thread
+ * from its signalfd, which hands them to the main thread. The teardown locks
+ * ordinary mutexes and waits on condition variables, so it must never run in
+ * a signal handler.
  */
 void DeanProcess::setupSignalHandlers() {
+  sigset_t mask;
+  sigemptyset(&mask);
   /* SECTION: Termination signals */
-  registerSignal(SIGINT, DeanProcess::terminationHandler);
-  registerSignal(SIGTERM, DeanProcess::terminationHandler);
-  registerSignal(SIGQUIT, DeanProcess::terminationHandler);
+  sigaddset(&mask, SIGINT);
+  sigaddset(&mask, SIGTERM);
+  sigaddset(&mask, SIGQUIT);
   /* END SECTION: Termination signals */
 
   /* SECTION: Evacuation signal */
-  registerSignal(SIGUSR1, DeanProcess::evacuationHandler);
+  sigaddset(&mask, SIGUSR1);
   /* END SECTION: Evacuation signal */
+
+  /* Blocked before any thread is created, so that every thread inherits it;
+   * signals arriving before the cleanup thread starts stay pending */
+  if (pthread_sigmask(SIG_BLOCK, &mask, &originalSignalMask) != 0) {
+    handleError("Failed to block the termination signals");
+  }
+
+  /* Ignored signals would be discarded instead of queued to the signalfd */
+  for (int signal : {SIGINT, SIGTERM, SIGQUIT, SIGUSR1}) {
+    registerSignal(signal, SIG_DFL);
+  }
 }
 
 /**
@@ -181,26 +371,60 @@ void DeanProcess::handleError(const char *message) {
     perror(message);
   }
 
-  /* Propagate the termination signal to all child processes and cleanup */
-  ProcessRegistry::propagateSignal(SIGTERM);
+  /* Terminate all child processes and cleanup */
   cleanup();
 
   exit(1);
 }
 
 /**
- * Waits for the exam to start.
+ * Waits for the exam to start: until every spawned participant has attached
+ * to the shared memory and the configured start time has passed.
  */
 void DeanProcess::waitForExamStart() {
-  int sleepTime = config.startTime - Time::now();
+  pthread_mutex_t *examStateMutex =
+      &SharedMemoryManager::data()->examStateMutex;
+  pthread_cond_t *examStateCond = &SharedMemoryManager::data()->examStateCond;
 
-  /* Sleep for at least 15 seconds to avoid race conditions */
-  sleepTime = std::max(sleepTime, 15);
+  /* Every commission shard and every admitted candidate */
+  int participants = config.sizeA.shardCount + config.sizeB.shardCount +
+                     config.candidateCount - rejected;
 
-  Logger::info("Waiting for exam start for " + std::to_string(sleepTime) +
-               " seconds");
+  Logger::info("Waiting for " + std::to_string(participants) +
+               " participants to get ready");
   try {
-    Misc::safeSleep(sleepTime);
+    uint64_t deadline = Time::monotonicNs() + readinessTimeoutMs * 1000000ULL;
+
+    MutexWrapper::lock(examStateMutex);
+    while (SharedMemoryManager::data()->readyCount < participants &&
+           pendingSignal == 0) {
+      uint64_t now = Time::monotonicNs();
+      if (now >= deadline) {
+        Logger::warn("Only " +
+                     std::to_string(SharedMemoryManager::data()->readyCount) +
+                     "/" + std::to_string(participants) +
+                     " participants ready, starting anyway");
+        break;
+      }
+      int timeoutMs = static_cast<int>((deadline - now) / 1000000) + 1;
+      if (timeoutMs > signalPollMs) {
+        timeoutMs = signalPollMs;
+      }
+      MutexWrapper::wait(examStateCond, examStateMutex, timeoutMs);
+    }
+    MutexWrapper::unlock(examStateMutex);
+    handlePendingSignal();
+
+    int sleepTime = config.startTime - Time::now();
+    if (sleepTime > 0) {
+      Logger::info("Waiting for exam start for " + std::to_string(sleepTime) +
+                   " seconds");
+      /* A second at a time, to handle signals while waiting */
+      for (; sleepTime > 0; sleepTime--) {
+        Misc::safeSleep(1);
+        handlePendingSignal();
+      }
+    }
   } catch (const std::exception &e) {
     std::string errorMessage =
         "Failed to sleep in waitForExamStart: " + std::string(e.what());
@@ -220,27 +444,41 @@ void DeanProcess::start() {
   try {
     MutexWrapper::lock(examStateMutex);
     SharedMemoryManager::data()->examStarted = true;
+    SharedMemoryManager::data()->timeline.examStartedAt = Time::monotonicNs();
+    pthread_cond_broadcast(&SharedMemoryManager::data()->examStateCond);
     MutexWrapper::unlock(examStateMutex);
+    Tracer::begin("dean", "exam");
+
+    startAutoscalerThread();
+
+    /* Commissions are reaped by the cleanup thread, the base shards run until
+     * their commission has graded every candidate */
+    for (int shard = 0; shard < config.sizeA.shardCount; shard++) {
+      int commissionAPID = SharedMemoryManager::data()->commissionAPID[shard];
+      if (commissionAPID != -1) {
+        waitForChild(commissionAPID);
+        Logger::info("Commission A" + std::to_string(shard) +
+                     " process finished");
+      }
+    }
 
-    int commissionAPID = SharedMemoryManager::data()->commissionAPID;
-    if (commissionAPID != -1) {
-      int status;
-      if (waitpid(commissionAPID, &status, 0) == -1 && errno != ECHILD) {
-        Logger::warn("Failed to wait for commission A: " +
-                     std::string(strerror(errno)));
-      } else {
-        Logger::info("Commission A process finished");
+    for (int shard = 0; shard < config.sizeB.shardCount; shard++) {
+      int commissionBPID = SharedMemoryManager::data()->commissionBID[shard];
+      if (commissionBPID != -1) {
+        waitForChild(commissionBPID);
+        Logger::info("Commission B" + std::to_string(shard) +
+                     " process finished");
       }
     }
 
-    int commissionBPID = SharedMemoryManager::data()->commissionBID;
-    if (commissionBPID != -1) {
-      int status;
-      if (waitpid(commissionBPID, &status, 0) == -1 && errno != ECHILD) {
-        Logger::warn("Failed to wait for commission B: " +
-                     std::string(strerror(errno)));
-      } else {
-        Logger::info("Commission B process finished");
+    /* Elastic shards still running leave together with the base shards */
+    stopAutoscalerThread();
+    for (int shard = 0; shard < maxCommissionShards; shard++) {
+      for (pid_t pid : {SharedMemoryManager::data()->commissionAPID[shard],
+                        SharedMemoryManager::data()->commissionBID[shard]}) {
+        if (pid > 0) {
+          waitForChild(pid);
+        }
       }
     }
   } catch (const std::exception &e) {
@@ -249,53 +487,375 @@ void DeanProcess::start() {
     handleError(errorMessage.c_str());
   }
 
+  Tracer::end("dean", "exam");
+
+  /* Candidates record their last timestamps after noticing the grade */
+  waitForChildren(examEndTimeoutMs);
+  handlePendingSignal();
+
   Logger::info("Exam ended. Publishing results...");
-  ResultsWriter::publishResults(false);
+
+  struct rusage usage;
+  MutexWrapper::lock(&childPidsMutex);
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    resourceUsage.add("dean", ResourceUsage::fromRusage(usage));
+  }
+  /* The page faults depend on how the shared memory is backed */
+  std::string resourceUsageContent =
+      resourceUsage.getTableContent() +
+      "\nPamiec dzielona: " + SharedMemoryManager::mode() + "\n" +
+      "Drobne bledy stron z wyprzedzeniem (prefault, wszystkie procesy): " +
+      std::to_string(SharedMemoryManager::data()->prefaultFaults.load()) +
+      "\n";
+  if (config.sizeA.maxShardCount > config.sizeA.shardCount ||
+      config.sizeB.maxShardCount > config.sizeB.shardCount) {
+    resourceUsageContent += autoscaler.getTableContent(
+        SharedMemoryManager::data()->timeline.examStartedAt);
+  }
+  MutexWrapper::unlock(&childPidsMutex);
+
+  ResultsWriter::publishResults(false, resourceUsageContent);
+  ResultsWriter::publishTimeline();
+
+  try {
+    Tracer::flush();
+    Tracer::merge(Namespace::outputPath("trace.json").c_str());
+  } catch (const std::exception &e) {
+    Logger::warn("Failed to merge trace: " + std::string(e.what()));
+  }
 }
 
 /**
- * Spawns commission processes.
+ * Waits for the child processes to exit, up to the given timeout.
+ *
+ * @param timeoutMs The timeout in milliseconds.
+ * @return True if all child processes have exited, false otherwise.
  */
-void DeanProcess::spawnComissions() {
-  /* Comission A */
-  pid_t pidA = fork();
-  if (pidA < 0) {
-    handleError("Failed in fork() call for commission A");
+bool DeanProcess::waitForChildren(int timeoutMs) {
+  struct timespec deadline;
+  clock_gettime(CLOCK_MONOTONIC, &deadline);
+  deadline.tv_sec += timeoutMs / 1000;
+  deadline.tv_nsec += (timeoutMs % 1000) * 1000000L;
+  if (deadline.tv_nsec >= 1000000000L) {
+    deadline.tv_sec++;
+    deadline.tv_nsec -= 1000000000L;
+  }
+
+  MutexWrapper::lock(&childPidsMutex);
+  int result = 0;
+  while (!childPids.empty() && result != ETIMEDOUT) {
+    result =
+        pthread_cond_timedwait(&childReapedCond, &childPidsMutex, &deadline);
   }
+  bool empty = childPids.empty();
+  MutexWrapper::unlock(&childPidsMutex);
 
-  if (pidA == 0) {
-    execlp("./commission", "./commission", "A", NULL);
-    handleError("Failed in execlp() call for commission A");
+  if (!empty) {
+    Logger::warn("Not all child processes exited after " +
+                 std::to_string(timeoutMs) + " ms");
   }
 
-  ProcessRegistry::registerCommission(pidA, 'A');
+  return empty;
+}
+
+/**
+ * Terminates the remaining child processes in bounded time: the process group
+ * receives SIGTERM and then SIGKILL, each followed by waiting for the cleanup
+ * thread to reap the children.
+ */
+void DeanProcess::terminateChildren() {
+  if (!cleanupRunning) {
+    return;
+  }
 
   MutexWrapper::lock(&childPidsMutex);
-  childPids.push_back(pidA);
+  bool empty = childPids.empty();
   MutexWrapper::unlock(&childPidsMutex);
+  if (empty) {
+    return;
+  }
 
-  pid_t pidB = fork();
-  if (pidB < 0) {
-    handleError("Failed in fork() call for commission B");
+  ProcessRegistry::propagateSignal(SIGTERM);
+  if (waitForChildren(teardownTimeoutMs)) {
+    return;
   }
 
-  if (pidB == 0) {
-    execlp("./commission", "./commission", "B", NULL);
-    handleError("Failed in execlp() call for commission B");
+  Logger::warn("Killing the remaining child processes");
+  ProcessRegistry::propagateSignal(SIGKILL);
+  waitForChildren(teardownTimeoutMs);
+}
+
+/**
+ * Waits for the given child process to be reaped by the cleanup thread, or
+ * for a termination or evacuation signal. Called by the main thread only.
+ *
+ * @param pid The pid of the child process.
+ */
+void DeanProcess::waitForChild(pid_t pid) {
+  MutexWrapper::lock(&childPidsMutex);
+  while (childPids.count(pid) != 0 && pendingSignal == 0) {
+    pthread_cond_wait(&childReapedCond, &childPidsMutex);
   }
+  MutexWrapper::unlock(&childPidsMutex);
+
+  handlePendingSignal();
+}
 
-  ProcessRegistry::registerCommission(pidB, 'B');
+/**
+ * Forks a child process and registers it for reaping. The pid is registered
+ * before the cleanup thread can reap it.
+ *
+ * @param processType The type of the process, used for resource accounting.
+ * @return The pid of the child in the parent, 0 in the child.
+ */
+pid_t DeanProcess::forkChild(const char *processType) {
+  /* The first child becomes the leader of the children's process group */
+  pid_t pgid = SharedMemoryManager::data()->childProcessGroup;
 
   MutexWrapper::lock(&childPidsMutex);
-  childPids.push_back(pidB);
+  pid_t pid = fork();
+  if (pid == 0) {
+    /* The child has no children, no cleanup thread and must not inherit
+     * blocked SIGCHLD */
+    childPids.clear();
+    MutexWrapper::unlock(&childPidsMutex);
+    cleanupRunning = false;
+    autoscalerRunning = false;
+    pthread_sigmask(SIG_SETMASK, &originalSignalMask, nullptr);
+    setpgid(0, pgid);
+    return 0;
+  }
+
+  if (pid > 0) {
+    /* Also set by the parent, the child may not have run yet */
+    if (setpgid(pid, pgid) == -1 && errno != EACCES) {
+      Logger::warn("Failed to move process " + std::to_string(pid) +
+                   " to the process group: " + std::string(strerror(errno)));
+    }
+    if (pgid == 0) {
+      ProcessRegistry::registerProcessGroup(pid);
+    }
+
+    childPids[pid] = processType;
+    SharedMemoryManager::data()->metrics.spawned++;
+  }
   MutexWrapper::unlock(&childPidsMutex);
 
-  cleanupRunning = true;
-  if (pthread_create(&cleanupThread, nullptr, cleanupThreadFunction, this) !=
-      0) {
-    handleError("Failed to create cleanup thread");
+  return pid;
+}
+
+/**
+ * Spawns commission processes.
+ */
+void DeanProcess::spawnComissions() {
+  SharedMemoryManager::data()->timeline.spawnStartedAt = Time::monotonicNs();
+
+  startCleanupThread();
+
+  /* One process per commission shard */
+  for (char commission : {'A', 'B'}) {
+    int shardCount = commission == 'A' ? config.sizeA.shardCount
+                                       : config.sizeB.shardCount;
+    for (int shard = 0; shard < shardCount; shard++) {
+      handlePendingSignal();
+      spawnCommission(commission, shard);
+    }
+  }
+}
+
+/**
+ * Spawns the process of a commission shard.
+ *
+ * @param commission The commission type.
+ * @param shard The shard.
+ */
+void DeanProcess::spawnCommission(char commission, int shard) {
+  std::string type(1, commission);
+  std::string shardArgument = std::to_string(shard);
+
+  uint64_t spawnStart = Time::monotonicNs();
+  pid_t pid = forkChild("commission");
+  if (pid < 0) {
+    handleError(("Failed in fork() call for commission " + type).c_str());
+  }
+
+  if (pid == 0) {
+    execlp("./commission", "./commission", type.c_str(), shardArgument.c_str(),
+           NULL);
+    handleError(("Failed in execlp() call for commission " + type).c_str());
+  }
+
+  ProcessRegistry::registerCommission(pid, commission, shard);
+  Tracer::complete("dean", "spawn commission", spawnStart, Time::monotonicNs(),
+                   pid);
+}
+
+/**
+ * Starts the thread scaling the commissions, if any commission may grow.
+ */
+void DeanProcess::startAutoscalerThread() {
+  if (config.sizeA.maxShardCount == config.sizeA.shardCount &&
+      config.sizeB.maxShardCount == config.sizeB.shardCount) {
+    return;
+  }
+
+  autoscalerRunning = true;
+  int result = pthread_create(&autoscalerThread, nullptr,
+                              DeanProcess::autoscalerThreadFunction, this);
+  if (result != 0) {
+    autoscalerRunning = false;
+    Logger::warn("Failed to create autoscaler thread: " +
+                 std::string(strerror(result)));
   }
-  Logger::info("Cleanup thread started");
+}
+
+/**
+ * Stops the autoscaler thread, so that no shard is spawned afterwards.
+ */
+void DeanProcess::stopAutoscalerThread() {
+  if (!autoscalerRunning) {
+    return;
+  }
+
+  autoscalerRunning = false;
+  /* Errors while scaling clean up from the autoscaler thread itself */
+  if (!pthread_equal(pthread_self(), autoscalerThread)) {
+    pthread_join(autoscalerThread, nullptr);
+  }
+}
+
+/**
+ * Samples the commission queues periodically until stopped.
+ *
+ * @param arg The dean process.
+ */
+void *DeanProcess::autoscalerThreadFunction(void *arg) {
+  DeanProcess *dean = static_cast<DeanProcess *>(arg);
+  Tracer::setThreadName("autoscaler");
+
+  while (dean->autoscalerRunning) {
+    try {
+      Misc::safeUSleep(scalingIntervalMs * 1000);
+      if (dean->autoscalerRunning) {
+        dean->scaleCommissions();
+      }
+    } catch (const std::exception &e) {
+      Logger::warn("Failed to scale commissions: " + std::string(e.what()));
+    }
+  }
+
+  return nullptr;
+}
+
+/**
+ * Spawns or retires an elastic shard of each commission, depending on the
+ * number of candidates waiting for a seat.
+ */
+void DeanProcess::scaleCommissions() {
+  SharedState *state = SharedMemoryManager::data();
+
+  for (char commission : {'A', 'B'}) {
+    int index = commission == 'A' ? 0 : 1;
+    const CommissionSize &size = commission == 'A' ? config.sizeA : config.sizeB;
+    if (size.maxShardCount == size.shardCount) {
+      continue;
+    }
+
+    int openShards = 0;
+    for (int shard = 0; shard < size.maxShardCount; shard++) {
+      openShards += Memory::commission(commission, shard)->open() ? 1 : 0;
+    }
+    int queued = state->metrics.commissions[index].queued;
+
+    ScalingAction action = autoscaler.decide(index, queued, openShards,
+                                             size.shardCount,
+                                             size.maxShardCount);
+    int shard = -1;
+
+    if (action == SpawnShard) {
+      /* The first slot whose previous process has left */
+      for (int i = size.shardCount; i < size.maxShardCount && shard == -1;
+           i++) {
+        if (!Memory::commission(commission, i)->active) {
+          shard = i;
+        }
+      }
+      if (shard == -1 || !activateShard(commission, shard)) {
+        continue;
+      }
+      spawnCommission(commission, shard);
+      openShards++;
+    } else if (action == RetireShard) {
+      /* The most recently added shard still open */
+      for (int i = size.maxShardCount - 1; i >= size.shardCount && shard == -1;
+           i--) {
+        if (Memory::commission(commission, i)->open()) {
+          shard = i;
+        }
+      }
+      if (shard == -1) {
+        continue;
+      }
+
+      /* Candidates queue under the shard mutex, see CandidateProcess */
+      pthread_mutex_t *shardMutex = Memory::commissionMutex(commission, shard);
+      MutexWrapper::lock(shardMutex);
+      Memory::commission(commission, shard)->retiring = true;
+      MutexWrapper::unlock(shardMutex);
+      openShards--;
+    } else {
+      continue;
+    }
+
+    Logger::info(std::string(action == SpawnShard ? "Spawned" : "Retiring") +
+                 " commission " + std::string(1, commission) + " shard " +
+                 std::to_string(shard) + " with " + std::to_string(queued) +
+                 " candidates waiting, " + std::to_string(openShards) +
+                 " shards open");
+    Tracer::instant("dean", action == SpawnShard ? "spawn shard"
+                                                 : "retire shard",
+                    shard);
+    autoscaler.record({Time::monotonicNs(), commission, shard, action, queued,
+                       openShards});
+  }
+}
+
+/**
+ * Prepares an elastic shard for its process: counts it as running and opens
+ * it to candidates, unless its commission has already graded everyone.
+ *
+ * @param commission The commission type.
+ * @param shard The shard.
+ * @return True if the shard has been activated, false otherwise.
+ */
+bool DeanProcess::activateShard(char commission, int shard) {
+  SharedState *state = SharedMemoryManager::data();
+  pthread_mutex_t *examStateMutex = &state->examStateMutex;
+  bool isA = commission == 'A';
+
+  MutexWrapper::lock(examStateMutex);
+  int graded = (isA ? state->commissionAGradedCount
+                    : state->commissionBGradedCount)
+                   .value.load(std::memory_order_acquire);
+  int candidates = (isA ? state->commissionACandidateCount
+                        : state->commissionBCandidateCount)
+                       .value.load(std::memory_order_acquire);
+  if (graded >= candidates ||
+      state->timeline.commissionFinishedAt[isA ? 0 : 1] != 0) {
+    MutexWrapper::unlock(examStateMutex);
+    return false;
+  }
+  (isA ? state->commissionAActiveShards : state->commissionBActiveShards)++;
+  MutexWrapper::unlock(examStateMutex);
+
+  pthread_mutex_t *shardMutex = Memory::commissionMutex(commission, shard);
+  MutexWrapper::lock(shardMutex);
+  CommissionInfo *info = Memory::commission(commission, shard);
+  info->retiring = false;
+  info->active = true;
+  MutexWrapper::unlock(shardMutex);
+
+  return true;
 }
 
 /**
@@ -348,8 +908,59 @@ void DeanProcess::spawnCandidates() {
   pid_t candidatePid;
   bool failed, retake;
 
+  Tracer::begin("dean", "spawn candidates");
+
   for (int i = 0; i < config.candidateCount; i++) {
-    candidatePid = fork();
+    handlePendingSignal();
+
+    failed = failedExamIndices.find(i) != failedExamIndices.end();
+    retake = retakeExamIndices.find(i) != retakeExamIndices.end();
+
+    /* Candidates without the matura are rejected without spawning a process */
+    if (failed) {
+      try {
+        MutexWrapper::lock(candidatesMutex);
+
+        CandidateInfo *candidate = &SharedMemoryManager::data()->candidates[i];
+        candidate->pid = -1;
+        candidate->exited = true;
+        candidate->scoreSequence.beginWrite();
+        candidate->theoreticalScore = -1.0;
+        candidate->practicalScore = -1.0;
+        candidate->finalScore = -1.0;
+        Memory::setStatus(candidate, NotEligible);
+        candidate->scoreSequence.endWrite();
+
+        MutexWrapper::unlock(candidatesMutex);
+      } catch (const std::exception &e) {
+        std::string errorMessage = "Failed to reject candidate " +
+                                   std::to_string(i) + ": " +
+                                   std::string(e.what());
+        handleError(errorMessage.c_str());
+      }
+
+      rejected++;
+      continue;
+    }
+
+    /* With -j every candidate answers at its own pace */
+    std::vector<double> candidateTimesA = config.timesA;
+    std::vector<double> candidateTimesB = config.timesB;
+    if (perCandidateTimes) {
+      for (double &time : candidateTimesA) {
+        time = Random::randomDouble(0.25, 1.0);
+      }
+      for (double &time : candidateTimesB) {
+        time = Random::randomDouble(0.25, 1.0);
+      }
+    }
+
+    /* Answer times of every member, comma-separated */
+    std::string timesA = DeanConfig::join(candidateTimesA);
+    std::string timesB = DeanConfig::join(candidateTimesB);
+
+    uint64_t spawnStart = Time::monotonicNs();
+    candidatePid = forkChild("candidate");
     if (candidatePid < 0) {
       std::string errorMessage =
           "Failed in fork() call for candidate " + std::to_string(i);
@@ -358,49 +969,46 @@ void DeanProcess::spawnCandidates() {
 
     if (candidatePid == 0) {
       execlp("./candidate", "./candidate", std::to_string(i).c_str(),
-             std::to_string(config.timesA[0]).c_str(),
-             std::to_string(config.timesA[1]).c_str(),
-             std::to_string(config.timesA[2]).c_str(),
-             std::to_string(config.timesA[3]).c_str(),
-             std::to_string(config.timesA[4]).c_str(),
-             std::to_string(config.timesB[0]).c_str(),
-             std::to_string(config.timesB[1]).c_str(),
-             std::to_string(config.timesB[2]).c_str(), NULL);
+             timesA.c_str(), timesB.c_str(), NULL);
       std::string errorMessage =
           "Failed in execlp() call for candidate " + std::to_string(i);
       handleError(errorMessage.c_str());
     } else {
       try {
-        MutexWrapper::lock(&childPidsMutex);
-        childPids.push_back(candidatePid);
-        MutexWrapper::unlock(&childPidsMutex);
-
         MutexWrapper::lock(candidatesMutex);
 
         SharedMemoryManager::data()->candidates[i].pid = candidatePid;
-        SharedMemoryManager::data()->candidates[i].practicalScore = -1.0;
-        SharedMemoryManager::data()->candidates[i].finalScore = -1.0;
-
-        failed = failedExamIndices.find(i) != failedExamIndices.end();
-        retake = retakeExamIndices.find(i) != retakeExamIndices.end();
 
-        if (failed) {
-          SharedMemoryManager::data()->candidates[i].status = NotEligible;
+        CandidateInfo *candidate = &SharedMemoryManager::data()->candidates[i];
+        candidate->retaking = retake;
+        candidate->expectedService[0] = std::accumulate(
+            candidateTimesA.begin(), candidateTimesA.end(), 0.0);
+        candidate->expectedService[1] = std::accumulate(
+            candidateTimesB.begin(), candidateTimesB.end(), 0.0);
+
+        /* The candidate may already be reading its scores */
+        candidate->scoreSequence.beginWrite();
+        candidate->practicalScore = -1.0;
+        candidate->finalScore = -1.0;
+        if (retake) {
+          Memory::setStatus(candidate, PendingCommissionB);
         } else {
-          SharedMemoryManager::data()->candidates[i].status =
-              PendingCommissionA;
+          Memory::setStatus(candidate, PendingCommissionA);
         }
 
         if (retake) {
           double theoreticalScore = Random::randomDouble(30.0, 100.0);
-          SharedMemoryManager::data()->candidates[i].theoreticalScore =
-              theoreticalScore;
+          candidate->theoreticalScore = theoreticalScore;
           retaking++;
         } else {
-          SharedMemoryManager::data()->candidates[i].theoreticalScore = -1.0;
+          candidate->theoreticalScore = -1.0;
         }
+        candidate->scoreSequence.endWrite();
 
         MutexWrapper::unlock(candidatesMutex);
+
+        Tracer::complete("dean", "spawn candidate", spawnStart,
+                         Time::monotonicNs(), i);
       } catch (const std::exception &e) {
         std::string errorMessage = "Failed to spawn candidate " +
                                    std::to_string(i) + ": " +
@@ -409,60 +1017,80 @@ void DeanProcess::spawnCandidates() {
       }
     }
   }
+
+  SharedMemoryManager::data()->timeline.spawnFinishedAt = Time::monotonicNs();
+  Tracer::end("dean", "spawn candidates");
 }
 
 /**
- * Verifies candidates eligibility for the exam.
+ * Publishes the number of candidates admitted to each commission. Candidates
+ * without the matura have already been rejected in spawnCandidates().
  */
 void DeanProcess::verifyCandidates() {
-  pthread_mutex_t *candidatesMutex =
-      &SharedMemoryManager::data()->candidateMutex;
-
-  int rejected = 0;
-
-  try {
-    MutexWrapper::lock(candidatesMutex);
-
-    for (int i = 0; i < config.candidateCount; i++) {
-      if (SharedMemoryManager::data()->candidates[i].status == NotEligible) {
-        int result =
-            kill(SharedMemoryManager::data()->candidates[i].pid, SIGUSR2);
-        if (result < 0) {
-          std::string errorMessage = "Failed to send SIGUSR2 to candidate " +
-                                     std::to_string(i) + ": " +
-                                     std::strerror(errno);
-          handleError(errorMessage.c_str());
-        }
-        rejected++;
-      }
-    }
+  Logger::info("Rejected " + std::to_string(rejected) +
+               " candidates without the matura");
 
-    MutexWrapper::unlock(candidatesMutex);
+  /* Published before the exam starts, the readiness barrier orders them
+   * before any grading */
+  int commissionBCount = config.candidateCount - rejected;
+  SharedMemoryManager::data()->commissionACandidateCount.value.store(
+      commissionBCount - retaking, std::memory_order_relaxed);
+  SharedMemoryManager::data()->commissionBCandidateCount.value.store(
+      commissionBCount, std::memory_order_relaxed);
+}
 
-  } catch (const std::exception &e) {
-    std::string errorMessage =
-        "Failed to verify candidates " + std::string(e.what());
-    handleError(errorMessage.c_str());
+/**
+ * Blocks SIGCHLD and starts the cleanup thread, which reaps the child
+ * processes as their SIGCHLD arrives through a signalfd. The termination and
+ * evacuation signals, blocked by setupSignalHandlers(), arrive through the
+ * same signalfd.
+ */
+void DeanProcess::startCleanupThread() {
+  sigset_t mask;
+  sigemptyset(&mask);
+  sigaddset(&mask, SIGCHLD);
+
+  /* Blocked before the thread is created so that no thread receives it */
+  if (pthread_sigmask(SIG_BLOCK, &mask, nullptr) != 0) {
+    handleError("Failed to block SIGCHLD");
   }
 
-  pthread_mutex_t *examStateMutex =
-      &SharedMemoryManager::data()->examStateMutex;
-  MutexWrapper::lock(examStateMutex);
+  sigaddset(&mask, SIGINT);
+  sigaddset(&mask, SIGTERM);
+  sigaddset(&mask, SIGQUIT);
+  sigaddset(&mask, SIGUSR1);
+  signalFd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+  if (signalFd == -1) {
+    handleError("Failed to create signalfd");
+  }
 
-  int commissionBCount = config.candidateCount - rejected;
-  SharedMemoryManager::data()->commissionACandidateCount =
-      commissionBCount - retaking;
-  SharedMemoryManager::data()->commissionBCandidateCount = commissionBCount;
+  stopFd = eventfd(0, EFD_CLOEXEC);
+  if (stopFd == -1) {
+    handleError("Failed to create eventfd for the cleanup thread");
+  }
 
-  MutexWrapper::unlock(examStateMutex);
+  int result =
+      pthread_create(&cleanupThread, nullptr, cleanupThreadFunction, this);
+  if (result != 0) {
+    handleError("Failed to create cleanup thread");
+  }
+  cleanupRunning = true;
+  Logger::info("Cleanup thread started");
 }
 
 /**
- * Cleans up the dean process.
+ * Stops the cleanup thread after it has reaped the remaining children.
  */
 void DeanProcess::stopCleanupThread() {
   if (cleanupRunning) {
     cleanupRunning = false;
+
+    uint64_t stop = 1;
+    if (write(stopFd, &stop, sizeof(stop)) != sizeof(stop)) {
+      Logger::warn("Failed to signal cleanup thread: " +
+                   std::string(strerror(errno)));
+    }
+
     if (pthread_join(cleanupThread, nullptr) != 0) {
       Logger::warn("Failed to join cleanup thread");
     }
@@ -473,13 +1101,16 @@ void DeanProcess::stopCleanupThread() {
 void DeanProcess::cleanup() {
   Logger::info("DeanProcess::cleanup()");
 
+  stopAutoscalerThread();
+  terminateChildren();
   stopCleanupThread();
 
   try {
+#ifdef MUTEX_PROFILING
+    ResultsWriter::publishMutexReport();
+#endif
     SharedMemoryManager::destroy();
-    SemaphoreManager::unlink("/commissionA");
-    SemaphoreManager::unlink("/commissionB");
-    SemaphoreManager::unlink("/logger");
+    SemaphoreManager::unlink(Namespace::ipcName("logger"));
   } catch (const std::exception &e) {
     std::string errorMessage =
         "Failed to cleanup the dean process: " + std::string(e.what());
@@ -490,90 +1121,157 @@ void DeanProcess::cleanup() {
 }
 
 /**
- * Handles the evacuation signal.
+ * Records a termination or evacuation signal read by the cleanup thread and
+ * wakes up the main thread, which handles it in handlePendingSignal(). Only
+ * the first signal is handled.
+ *
+ * @param signal The signal.
  */
-void DeanProcess::evacuationHandler(int signal) {
-  Logger::info("DeanProcess::evacuationHandler()");
-  Logger::info("Evacuation signal received");
+void DeanProcess::signalReceived(int signal) {
+  int expected = 0;
+  if (!pendingSignal.compare_exchange_strong(expected, signal)) {
+    return;
+  }
 
-  ProcessRegistry::propagateSignal(SIGTERM);
-  ResultsWriter::publishResults(true);
+  Logger::info("Signal SIG " + std::to_string(signal) +
+               " received, handing it to the main thread");
 
-  if (instance_) {
-    static_cast<DeanProcess *>(instance_)->cleanup();
-    instance_ = nullptr;
-  } else {
-    Logger::error("No instance found for evacuation handler");
-    exit(1);
-  }
+  /* The main thread may be waiting for a child or for the participants */
+  MutexWrapper::lock(&childPidsMutex);
+  pthread_cond_broadcast(&childReapedCond);
+  MutexWrapper::unlock(&childPidsMutex);
 
-  exit(0);
+  /* Without the exam state mutex, which a terminated child may have left
+   * locked; the main thread waits for the participants in short slices */
+  pthread_cond_broadcast(&SharedMemoryManager::data()->examStateCond);
 }
 
 /**
- * Handles the termination signal.
+ * Handles the termination or evacuation signal received so far, if any, and
+ * exits. Called by the main thread between the steps of the exam, without
+ * holding any mutex.
  */
-void DeanProcess::terminationHandler(int signal) {
-  Logger::info("DeanProcess::terminationHandler()");
-  Logger::info("Termination signal: SIG " + std::to_string(signal) +
-               " received");
-
-  ProcessRegistry::propagateSignal(SIGTERM);
+void DeanProcess::handlePendingSignal() {
+  int signal = pendingSignal;
+  if (signal == 0) {
+    return;
+  }
 
-  if (instance_) {
-    static_cast<DeanProcess *>(instance_)->cleanup();
-    instance_ = nullptr;
+  SharedMemoryManager::data()->examInterrupted = true;
+  if (signal == SIGUSR1) {
+    Logger::info("Evacuation signal received");
+    ProcessRegistry::propagateSignal(SIGTERM);
+    ResultsWriter::publishResults(true);
   } else {
-    Logger::error("No instance found for evacuation handler");
-    exit(1);
+    Logger::info("Termination signal: SIG " + std::to_string(signal) +
+                 " received");
   }
 
+  /* The child processes are terminated by cleanup() */
+  cleanup();
+  instance_ = nullptr;
+
   exit(0);
 }
 
 /**
- * Cleans up the child processes
+ * Cleans up the child processes. Sleeps until SIGCHLD arrives or the thread is
+ * stopped, then reaps every child that has exited.
  */
 void *DeanProcess::cleanupThreadFunction(void *arg) {
   DeanProcess *self = static_cast<DeanProcess *>(arg);
   Logger::info("Cleanup thread started");
+  Tracer::setThreadName("cleanup");
 
-  while (self->cleanupRunning) {
-    int status;
-    try {
-      pid_t waitedPid = waitpid(-1, &status, WNOHANG);
-      if (waitedPid > 0) {
-        MutexWrapper::lock(&self->childPidsMutex);
-        self->childPids.erase(std::remove(self->childPids.begin(),
-                                          self->childPids.end(), waitedPid),
-                              self->childPids.end());
-        MutexWrapper::unlock(&self->childPidsMutex);
-        Logger::info("Cleanup thread: cleaned up process " +
-                     std::to_string(waitedPid));
-      } else if (waitedPid == 0) {
-        Misc::safeUSleep(100000);
-      } else if (errno == ECHILD) {
-        Misc::safeUSleep(100000);
+  struct pollfd fds[2] = {{self->signalFd, POLLIN, 0},
+                          {self->stopFd, POLLIN, 0}};
+
+  while (true) {
+    if (poll(fds, 2, -1) == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      Logger::warn("Cleanup thread: poll() failed: " +
+                   std::string(strerror(errno)));
+      break;
+    }
+
+    if (fds[1].revents & POLLIN) {
+      break;
+    }
+
+    if (fds[0].revents & POLLIN) {
+      /* SIGCHLD is coalesced, so drain it and reap every exited child */
+      struct signalfd_siginfo info;
+      while (read(self->signalFd, &info, sizeof(info)) == sizeof(info)) {
+        if (info.ssi_signo != SIGCHLD) {
+          self->signalReceived(info.ssi_signo);
+        }
+      }
+
+      try {
+        self->reapChildren();
+      } catch (const std::exception &e) {
+        Logger::warn("Exception in cleanup thread: " + std::string(e.what()));
       }
-    } catch (const std::exception &e) {
-      Logger::warn("Exception in cleanup thread: " + std::string(e.what()));
-      Misc::safeUSleep(100000);
     }
   }
 
   Logger::info("Cleanup thread: doing final cleanup");
   MutexWrapper::lock(&self->childPidsMutex);
-  std::vector<pid_t> remainingPids = self->childPids;
+  std::vector<pid_t> remainingPids;
+  for (const auto &child : self->childPids) {
+    remainingPids.push_back(child.first);
+  }
   MutexWrapper::unlock(&self->childPidsMutex);
 
   for (pid_t pid : remainingPids) {
     int status;
-    if (waitpid(pid, &status, 0) > 0) {
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) > 0) {
+      self->childReaped(pid, usage);
       Logger::info("Cleanup thread: final cleanup of process " +
                    std::to_string(pid));
     }
   }
 
+  close(self->signalFd);
+  close(self->stopFd);
+
   Logger::info("Cleanup thread exiting");
   return nullptr;
 }
+
+/**
+ * Reaps every child process that has exited, without blocking.
+ */
+void DeanProcess::reapChildren() {
+  int status;
+  struct rusage usage;
+  pid_t pid;
+  while ((pid = wait4(-1, &status, WNOHANG, &usage)) > 0) {
+    childReaped(pid, usage);
+    Logger::info("Cleanup thread: cleaned up process " + std::to_string(pid));
+  }
+}
+
+/**
+ * Removes a reaped child process, records its resource usage and wakes up the
+ * threads waiting for it.
+ *
+ * @param pid The pid of the child process.
+ * @param usage The resource usage of the child process.
+ */
+void DeanProcess::childReaped(pid_t pid, const struct rusage &usage) {
+  MutexWrapper::lock(&childPidsMutex);
+  auto child = childPids.find(pid);
+  if (child != childPids.end()) {
+    resourceUsage.add(child->second, ResourceUsage::fromRusage(usage));
+    childPids.erase(child);
+  }
+  pthread_cond_broadcast(&childReapedCond);
+  MutexWrapper::unlock(&childPidsMutex);
+
+  SharedMemoryManager::data()->metrics.reaped++;
+  Tracer::instant("dean", "reap", pid);
+}
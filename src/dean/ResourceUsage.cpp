@@ -0,0 +1,83 @@
+#include "dean/ResourceUsage.h"
+
+#include "common/utils/Stats.h"
+#include <cstdio>
+
+/**
+ * Convert the usage returned by wait4() or getrusage().
+ *
+ * @param usage The usage.
+ * @return The resource usage.
+ */
+ResourceUsage ResourceUsage::fromRusage(const struct rusage &usage) {
+  ResourceUsage result;
+  result.userSeconds = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6;
+  result.systemSeconds = usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+  result.maxRssKb = usage.ru_maxrss;
+  result.voluntarySwitches = usage.ru_nvcsw;
+  result.involuntarySwitches = usage.ru_nivcsw;
+  result.minorFaults = usage.ru_minflt;
+  result.majorFaults = usage.ru_majflt;
+  return result;
+}
+
+/**
+ * Record the resource usage of a process.
+ *
+ * @param processType The type of the process (dean, commission, candidate).
+ * @param usage The resource usage.
+ */
+void ResourceUsageReport::add(const std::string &processType,
+                              const ResourceUsage &usage) {
+  samples_[processType].push_back(usage);
+}
+
+/**
+ * Get the totals and distributions of the resource usage per process type.
+ *
+ * @return The report formatted as a table.
+ */
+std::string ResourceUsageReport::getTableContent() const {
+  std::string content = "\n| ==== Zuzycie zasobow ==== |\n";
+  content += "| Typ procesu | Liczba | Metryka | Suma | Srednia | p50 | p99 | "
+             "Max |\n";
+  content += "|-------------|--------|---------|------|---------|-----|-----|"
+             "-----|\n";
+
+  for (const auto &entry : samples_) {
+    const std::vector<ResourceUsage> &usages = entry.second;
+
+    std::vector<std::pair<const char *, std::vector<double>>> metrics = {
+        {"CPU uzytkownika [s]", {}},   {"CPU systemu [s]", {}},
+        {"Max RSS [KB]", {}},          {"Dobrowolne przelaczenia", {}},
+        {"Wymuszone przelaczenia", {}}, {"Drobne bledy stron", {}},
+        {"Powazne bledy stron", {}}};
+    for (const ResourceUsage &usage : usages) {
+      metrics[0].second.push_back(usage.userSeconds);
+      metrics[1].second.push_back(usage.systemSeconds);
+      metrics[2].second.push_back(usage.maxRssKb);
+      metrics[3].second.push_back(usage.voluntarySwitches);
+      metrics[4].second.push_back(usage.involuntarySwitches);
+      metrics[5].second.push_back(usage.minorFaults);
+      metrics[6].second.push_back(usage.majorFaults);
+    }
+
+    for (const auto &metric : metrics) {
+      const std::vector<double> &values = metric.second;
+      double sum = 0.0;
+      for (double value : values) {
+        sum += value;
+      }
+
+      char buffer[256];
+      snprintf(buffer, sizeof(buffer),
+               "| %s | %zu | %s | %.3f | %.3f | %.3f | %.3f | %.3f |\n",
+               entry.first.c_str(), usages.size(), metric.first, sum,
+               Stats::mean(values), Stats::percentile(values, 50.0),
+               Stats::percentile(values, 99.0), Stats::max(values));
+      content += buffer;
+    }
+  }
+
+  return content;
+}
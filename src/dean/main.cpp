@@ -1,13 +1,26 @@
 #include "dean/DeanProcess.h"
 
+#include "common/ipc/Namespace.h"
+#include "common/ipc/SharedMemoryManager.h"
+#include <iostream>
+
 int main(int argc, char *argv[]) {
+  /* Inherited by the children through the environment */
+  try {
+    Namespace::name();
+    SharedMemoryManager::options();
+  } catch (const std::exception &e) {
+    std::cerr << "Failed to validate arguments: \n\t" << e.what() << std::endl;
+    return 1;
+  }
+
   DeanProcess deanProcess(argc, argv);
 
   deanProcess.spawnComissions();
   deanProcess.spawnCandidates();
 
-  deanProcess.waitForExamStart();
   deanProcess.verifyCandidates();
+  deanProcess.waitForExamStart();
   deanProcess.start();
 
   deanProcess.cleanup();
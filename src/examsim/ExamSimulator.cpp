@@ -0,0 +1,387 @@
+#include "examsim/ExamSimulator.h"
+
+#include "common/output/ResultsWriter.h"
+#include "common/utils/Random.h"
+#include "common/utils/Stats.h"
+#include <chrono>
+#include <cmath>
+#include <unordered_set>
+
+namespace {
+
+/**
+ * Time after which a polling process notices a change, given that it checks
+ * once per second starting at the given time.
+ *
+ * @param since The time the polling started.
+ * @param now The time of the change.
+ * @return The time the change is noticed.
+ */
+double nextPoll(double since, double now) {
+  return since + std::ceil(now - since);
+}
+
+} // namespace
+
+/**
+ * Constructor for the exam simulator.
+ *
+ * @param simulationConfig The simulation parameters.
+ */
+ExamSimulator::ExamSimulator(const SimulationConfig &simulationConfig)
+    : simulation(simulationConfig) {
+  if (simulation.seeded) {
+    Random::seed(simulation.seed);
+  }
+
+  config = DeanConfig(simulation.placeCount, 0);
+
+  /* Set up commissions */
+  int memberCounts[2] = {simulation.membersA, simulation.membersB};
+  for (int c = 0; c < 2; c++) {
+    SimulatedCommission &commission = commissions[c];
+    commission.type = c == 0 ? 'A' : 'B';
+    commission.memberCount = memberCounts[c];
+    commission.fullMask = (1ULL << memberCounts[c]) - 1;
+    commission.answerTime = 0.0;
+    for (int i = 0; i < memberCounts[c]; i++) {
+      const std::vector<double> &configured =
+          c == 0 ? config.timesA : config.timesB;
+      if (!simulation.customAnswerTimes && i < (int)configured.size()) {
+        commission.answerTime += configured[i];
+      } else {
+        commission.answerTime += Random::randomDouble(
+            simulation.answerTimeMin, simulation.answerTimeMax);
+      }
+    }
+
+    commission.seats.resize(simulation.seatCount);
+    for (int i = simulation.seatCount - 1; i >= 0; i--) {
+      commission.freeSeats.push_back(i);
+    }
+  }
+
+  /* Set up candidates the same way the dean does */
+  candidates.resize(config.candidateCount);
+  timelines.resize(config.candidateCount);
+
+  std::unordered_set<int> failedExamIndices =
+      Random::randomInts(config.failedExamCount, 0, config.candidateCount - 1);
+  std::unordered_set<int> retakeExamIndices =
+      Random::randomInts(config.retakeExamCount, 0, config.candidateCount - 1,
+                         failedExamIndices);
+
+  for (int i = 0; i < config.candidateCount; i++) {
+    CandidateInfo &candidate = candidates[i];
+    candidate.pid = -1;
+
+    if (failedExamIndices.find(i) != failedExamIndices.end()) {
+      candidate.status = NotEligible;
+      continue;
+    }
+
+    /* Candidates poll for the exam start once per second */
+    double arrival = Random::randomDouble(0.0, 1.0);
+    if (retakeExamIndices.find(i) != retakeExamIndices.end()) {
+      candidate.status = PendingCommissionB;
+      candidate.theoreticalScore = Random::randomDouble(30.0, 100.0);
+      schedule(arrival, CandidateArrival, 1, i);
+    } else {
+      candidate.status = PendingCommissionA;
+      commissions[0].expected++;
+      schedule(arrival, CandidateArrival, 0, i);
+    }
+
+    commissions[1].expected++;
+  }
+
+  /* Members wait 2-5 seconds before every scan of the seats */
+  for (int c = 0; c < 2; c++) {
+    for (int member = 0; member < commissions[c].memberCount; member++) {
+      schedule(Random::randomInt(2, 5), MemberScan, c, member);
+    }
+    schedule(0.0, CommissionTick, c, -1);
+  }
+}
+
+/**
+ * Runs the simulation until both commissions finish.
+ */
+void ExamSimulator::run() {
+  auto start = std::chrono::steady_clock::now();
+
+  while (!events.empty()) {
+    SimulationEvent event = events.top();
+    events.pop();
+    processedEvents++;
+    handleEvent(event);
+  }
+
+  wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                           start)
+                 .count();
+}
+
+/**
+ * Publishes the ranking followed by the timing statistics.
+ *
+ * @param path The path of the ranking file.
+ */
+void ExamSimulator::publishResults(const char *path) {
+  ResultsWriter::publishResults(candidates.data(),
+                                static_cast<int>(candidates.size()), false,
+                                path, getStatistics());
+}
+
+/**
+ * Gets the timing statistics of the simulation.
+ *
+ * @return The statistics formatted as a table.
+ */
+std::string ExamSimulator::getStatistics() {
+  std::vector<double> phases[2][4];
+  for (const SimulatedTimeline &timeline : timelines) {
+    for (int c = 0; c < 2; c++) {
+      if (timeline.seatedAt[c] >= 0.0) {
+        phases[c][0].push_back(timeline.seatedAt[c] - timeline.queuedAt[c]);
+      }
+      if (timeline.questionsAt[c] >= 0.0) {
+        phases[c][1].push_back(timeline.questionsAt[c] - timeline.seatedAt[c]);
+      }
+      if (timeline.answeredAt[c] >= 0.0) {
+        phases[c][2].push_back(timeline.answeredAt[c] -
+                               timeline.questionsAt[c]);
+      }
+      if (timeline.gradedAt[c] >= 0.0) {
+        phases[c][3].push_back(timeline.gradedAt[c] - timeline.answeredAt[c]);
+      }
+    }
+  }
+
+  const char *phaseNames[4] = {"Oczekiwanie na miejsce",
+                               "Oczekiwanie na pytania", "Odpowiadanie",
+                               "Oczekiwanie na ocene"};
+
+  std::string content = "\n| ==== Statystyki symulacji ==== |\n";
+  content += "| Kandydaci | " + std::to_string(config.candidateCount) + " |\n";
+  content += "| Miejsca w komisji | " + std::to_string(simulation.seatCount) +
+             " |\n";
+  content += "| Czlonkowie komisji A / B | " +
+             std::to_string(simulation.membersA) + " / " +
+             std::to_string(simulation.membersB) + " |\n";
+  content += "| Czas egzaminu [s] | " + std::to_string(makespan) + " |\n";
+
+  for (int c = 0; c < 2; c++) {
+    const SimulatedCommission &commission = commissions[c];
+    double duration = commission.finishedAt > 0.0 ? commission.finishedAt : 1.0;
+    std::string name = std::string("Komisja ") + commission.type;
+    content += "| " + name + " - ocenieni | " +
+               std::to_string(commission.processed) + " |\n";
+    content += "| " + name + " - przepustowosc [kand./s] | " +
+               std::to_string(commission.processed / duration) + " |\n";
+    content += "| " + name + " - wykorzystanie miejsc [%] | " +
+               std::to_string(commission.busySeatTime /
+                              (duration * simulation.seatCount) * 100.0) +
+               " |\n";
+  }
+
+  content += "\n| Faza | Liczba | Srednia [s] | p50 [s] | p95 [s] | p99 [s] | "
+             "Max [s] |\n";
+  content += "|------|--------|-------------|---------|---------|---------|----"
+             "-----|\n";
+  for (int c = 0; c < 2; c++) {
+    for (int phase = 0; phase < 4; phase++) {
+      const std::vector<double> &values = phases[c][phase];
+      content += "| " + std::string(phaseNames[phase]) + " (" +
+                 commissions[c].type + ") | " + std::to_string(values.size()) +
+                 " | " + std::to_string(Stats::mean(values)) + " | " +
+                 std::to_string(Stats::percentile(values, 50.0)) + " | " +
+                 std::to_string(Stats::percentile(values, 95.0)) + " | " +
+                 std::to_string(Stats::percentile(values, 99.0)) + " | " +
+                 std::to_string(Stats::max(values)) + " |\n";
+    }
+  }
+
+  content += "\n| Zdarzenia | " + std::to_string(processedEvents) + " |\n";
+  content += "| Czas obliczen [s] | " + std::to_string(wallTime) + " |\n";
+
+  return content;
+}
+
+/**
+ * Schedules an event.
+ *
+ * @param time The time of the event.
+ * @param type The type of the event.
+ * @param commission The commission the event refers to.
+ * @param target The candidate index or member id.
+ */
+void ExamSimulator::schedule(double time, SimulationEventType type,
+                             int commission, int target) {
+  events.push({time, nextSequence++, type, commission, target});
+}
+
+/**
+ * Handles a single event.
+ *
+ * @param event The event to handle.
+ */
+void ExamSimulator::handleEvent(const SimulationEvent &event) {
+  SimulatedCommission &commission = commissions[event.commission];
+  double now = event.time;
+
+  switch (event.type) {
+  case CandidateArrival:
+    timelines[event.target].queuedAt[event.commission] = now;
+    commission.queue.push_back(event.target);
+    assignSeats(event.commission, now);
+    break;
+  case MemberScan:
+    if (commission.finished) {
+      break;
+    }
+    scanSeats(event.commission, event.target, now);
+    schedule(now + Random::randomInt(2, 5), MemberScan, event.commission,
+             event.target);
+    break;
+  case QuestionsNoticed:
+    timelines[event.target].questionsAt[event.commission] = now;
+    schedule(now + commission.answerTime, AnswersReady, event.commission,
+             event.target);
+    break;
+  case AnswersReady:
+    timelines[event.target].answeredAt[event.commission] = now;
+    commission.seats[timelines[event.target].seat].answered = true;
+    break;
+  case CommissionTick:
+    if (commission.finished) {
+      break;
+    }
+    maybeFinish(event.commission, now);
+    if (!commission.finished) {
+      gradeCandidate(event.commission, now);
+      schedule(now + 1.0, CommissionTick, event.commission, -1);
+    }
+    break;
+  case GradeNoticed:
+    timelines[event.target].gradedAt[event.commission] = now;
+    if (event.commission == 0) {
+      if (candidates[event.target].theoreticalScore < 30.0) {
+        candidates[event.target].status = Failed;
+      } else {
+        candidates[event.target].status = PendingCommissionB;
+        schedule(now, CandidateArrival, 1, event.target);
+      }
+    } else {
+      candidates[event.target].status = Passed;
+    }
+    break;
+  }
+}
+
+/**
+ * Seats waiting candidates while there are free seats.
+ *
+ * @param commission The commission.
+ * @param now The current time.
+ */
+void ExamSimulator::assignSeats(int commission, double now) {
+  SimulatedCommission &info = commissions[commission];
+
+  while (!info.queue.empty() && !info.freeSeats.empty()) {
+    int candidate = info.queue.front();
+    info.queue.pop_front();
+    int seat = info.freeSeats.back();
+    info.freeSeats.pop_back();
+
+    info.seats[seat] = {candidate, 0, false};
+    timelines[candidate].seat = seat;
+    timelines[candidate].seatedAt[commission] = now;
+  }
+}
+
+/**
+ * Generates the member's question for every occupied seat.
+ *
+ * @param commission The commission.
+ * @param member The member id.
+ * @param now The current time.
+ */
+void ExamSimulator::scanSeats(int commission, int member, double now) {
+  SimulatedCommission &info = commissions[commission];
+  uint64_t memberBit = 1ULL << member;
+
+  for (SimulatedSeat &seat : info.seats) {
+    if (seat.candidate == -1 || (seat.questions & memberBit)) {
+      continue;
+    }
+
+    seat.questions |= memberBit;
+    if (seat.questions == info.fullMask) {
+      /* Candidates poll for questions once per second */
+      double seatedAt = timelines[seat.candidate].seatedAt[commission];
+      schedule(nextPoll(seatedAt, now), QuestionsNoticed, commission,
+               seat.candidate);
+    }
+  }
+}
+
+/**
+ * Grades the first candidate that has answered the questions.
+ *
+ * @param commission The commission.
+ * @param now The current time.
+ */
+void ExamSimulator::gradeCandidate(int commission, double now) {
+  SimulatedCommission &info = commissions[commission];
+
+  for (size_t i = 0; i < info.seats.size(); i++) {
+    SimulatedSeat &seat = info.seats[i];
+    if (seat.candidate == -1 || !seat.answered) {
+      continue;
+    }
+
+    CandidateInfo &candidate = candidates[seat.candidate];
+    double score = Random::sampleMean(info.memberCount, 0.0, 100.0);
+    if (commission == 0) {
+      candidate.theoreticalScore = score;
+      if (score < 30.0) {
+        commissions[1].expected--;
+      }
+    } else {
+      candidate.practicalScore = score;
+    }
+    info.processed++;
+
+    /* Candidates poll for the grade once per second */
+    SimulatedTimeline &timeline = timelines[seat.candidate];
+    info.busySeatTime += now - timeline.seatedAt[commission];
+    schedule(nextPoll(timeline.answeredAt[commission], now), GradeNoticed,
+             commission, seat.candidate);
+
+    seat = SimulatedSeat();
+    info.freeSeats.push_back(static_cast<int>(i));
+    assignSeats(commission, now);
+    return;
+  }
+}
+
+/**
+ * Finishes the commission if all its candidates have been graded.
+ *
+ * @param commission The commission.
+ * @param now The current time.
+ */
+void ExamSimulator::maybeFinish(int commission, double now) {
+  SimulatedCommission &info = commissions[commission];
+
+  if (info.processed >= info.expected &&
+      info.freeSeats.size() == info.seats.size()) {
+    info.finished = true;
+    info.finishedAt = now;
+
+    if (commission == 1) {
+      makespan = now;
+    }
+  }
+}
@@ -0,0 +1,112 @@
+#include "examsim/ExamSimulator.h"
+
+#include "common/ipc/CommissionInfo.h"
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+const char *usage =
+    "Usage: ./examsim <place count> [-s seats] [-a members A] [-b members B] "
+    "[-t min:max answer time] [-r seed]";
+
+/**
+ * Parses the arguments passed to the program.
+ *
+ * @param argc The number of arguments passed to the program.
+ * @param argv The arguments passed to the program.
+ * @return The simulation parameters.
+ * @throws std::invalid_argument If the arguments are invalid.
+ */
+SimulationConfig parseArguments(int argc, char *argv[]) {
+  SimulationConfig config;
+
+  int option;
+  while ((option = getopt(argc, argv, "s:a:b:t:r:")) != -1) {
+    switch (option) {
+    case 's':
+      config.seatCount = std::stoi(optarg);
+      break;
+    case 'a':
+      config.membersA = std::stoi(optarg);
+      break;
+    case 'b':
+      config.membersB = std::stoi(optarg);
+      break;
+    case 't': {
+      std::string range = optarg;
+      size_t colon = range.find(':');
+      if (colon == std::string::npos) {
+        throw std::invalid_argument("Answer time range must be min:max");
+      }
+      config.answerTimeMin = std::stod(range.substr(0, colon));
+      config.answerTimeMax = std::stod(range.substr(colon + 1));
+      config.customAnswerTimes = true;
+      break;
+    }
+    case 'r':
+      config.seed = static_cast<unsigned int>(std::stoul(optarg));
+      config.seeded = true;
+      break;
+    default:
+      throw std::invalid_argument(usage);
+    }
+  }
+
+  if (optind != argc - 1) {
+    throw std::invalid_argument(usage);
+  }
+
+  /* Expected value: n > 0 */
+  config.placeCount = std::stoi(argv[optind]);
+  if (config.placeCount <= 0) {
+    throw std::invalid_argument("Invalid place count. Expected: 0 < n");
+  }
+
+  /* Expected value: n > 0 */
+  if (config.seatCount <= 0) {
+    throw std::invalid_argument("Invalid seat count. Expected: 0 < n");
+  }
+
+  /* Expected value: 0 < n <= maxCommissionMembers, the limit of the dean */
+  if (config.membersA <= 0 || config.membersA > maxCommissionMembers ||
+      config.membersB <= 0 || config.membersB > maxCommissionMembers) {
+    throw std::invalid_argument("Invalid member count. Expected: 0 < n <= " +
+                                std::to_string(maxCommissionMembers));
+  }
+
+  /* Expected value: 0 < min <= max */
+  if (config.answerTimeMin <= 0.0 ||
+      config.answerTimeMax < config.answerTimeMin) {
+    throw std::invalid_argument(
+        "Invalid answer time range. Expected: 0 < min <= max");
+  }
+
+  return config;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  SimulationConfig config;
+  try {
+    config = parseArguments(argc, argv);
+  } catch (const std::exception &e) {
+    std::cerr << "Failed to validate arguments: \n\t" << e.what() << std::endl;
+    return 1;
+  }
+
+  try {
+    ExamSimulator simulator(config);
+    simulator.run();
+    simulator.publishResults("../output/lista_rankingowa_symulacja.txt");
+    std::cout << simulator.getStatistics();
+  } catch (const std::exception &e) {
+    std::cerr << "Simulation failed: " << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
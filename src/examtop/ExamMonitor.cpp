@@ -0,0 +1,105 @@
+#include "examtop/ExamMonitor.h"
+
+#include "common/ipc/SharedMemoryManager.h"
+#include "common/utils/Time.h"
+#include <cerrno>
+#include <cstdio>
+#include <signal.h>
+
+/**
+ * Constructor for the exam monitor.
+ *
+ * @throw std::runtime_error If no exam is running.
+ */
+ExamMonitor::ExamMonitor() { SharedMemoryManager::attach(true); }
+
+/**
+ * Destructor for the exam monitor.
+ */
+ExamMonitor::~ExamMonitor() {
+  try {
+    SharedMemoryManager::detach();
+  } catch (const std::exception &e) {
+    perror(e.what());
+  }
+}
+
+/**
+ * Samples the live counters of the exam.
+ *
+ * @return The counters formatted as a table.
+ */
+std::string ExamMonitor::snapshot() {
+  const SharedState *state = SharedMemoryManager::data();
+  const LiveMetrics &metrics = state->metrics;
+  uint64_t now = Time::monotonicNs();
+  uint64_t examStartedAt = state->timeline.examStartedAt;
+  double elapsed = examStartedAt != 0 ? (now - examStartedAt) / 1e9 : 0.0;
+  double interval = lastSampleAt_ != 0 ? (now - lastSampleAt_) / 1e9 : 0.0;
+
+  char buffer[256];
+  std::string content;
+
+  if (examStartedAt == 0) {
+    content += "Egzamin nie rozpoczal sie\n";
+  } else {
+    snprintf(buffer, sizeof(buffer), "Czas egzaminu: %.1f s\n", elapsed);
+    content += buffer;
+  }
+
+  snprintf(buffer, sizeof(buffer),
+           "Procesy potomne: utworzone %d, zakonczone %d\n\n",
+           metrics.spawned.load(), metrics.reaped.load());
+  content += buffer;
+
+  const char *statusNames[CandidateStatusCount] = {
+      "Oczekujacy",      "Niedopuszczeni", "Komisja A", "Niezdani",
+      "Komisja B",       "Zdani",          "Zakonczeni"};
+  content += "| Status | Kandydaci |\n|--------|-----------|\n";
+  for (int i = 0; i < CandidateStatusCount; i++) {
+    snprintf(buffer, sizeof(buffer), "| %s | %d |\n", statusNames[i],
+             metrics.statusCounts[i].load());
+    content += buffer;
+  }
+
+  content += "\n| Komisja | Kolejka | Zajete miejsca | Ocenieni | Oceny/s "
+             "(biezace) | Oceny/s (srednio) |\n|---------|---------|----------"
+             "------|----------|-------------------|-------------------|\n";
+  for (int i = 0; i < 2; i++) {
+    const CommissionMetrics &commission = metrics.commissions[i];
+    /* Seats of all shards */
+    int seatCount = i == 0 ? state->commissionA[0].seatCount *
+                                 state->commissionAShardCount
+                           : state->commissionB[0].seatCount *
+                                 state->commissionBShardCount;
+    int graded = commission.graded.load();
+    snprintf(buffer, sizeof(buffer), "| %c | %d | %d/%d | %d | %.2f | %.2f |\n",
+             i == 0 ? 'A' : 'B', commission.queued.load(),
+             commission.seatsBusy.load(), seatCount, graded,
+             interval > 0.0 ? (graded - lastGraded_[i]) / interval : 0.0,
+             elapsed > 0.0 ? graded / elapsed : 0.0);
+    content += buffer;
+    lastGraded_[i] = graded;
+  }
+
+  lastSampleAt_ = now;
+  return content;
+}
+
+/**
+ * Checks whether the exam has finished. An exam interrupted by a signal or
+ * whose dean is gone (crashed, shared memory unlinked) never finishes
+ * grading, so it counts as finished too.
+ *
+ * @return True if the exam has finished, false otherwise.
+ */
+bool ExamMonitor::finished() const {
+  const SharedState *state = SharedMemoryManager::data();
+  if (state->timeline.commissionFinishedAt[1] != 0 ||
+      state->examInterrupted.load()) {
+    return true;
+  }
+
+  return state->deanPID != 0 && kill(state->deanPID, 0) == -1 &&
+         errno == ESRCH;
+}
@@ -0,0 +1,78 @@
+#include "examtop/ExamMonitor.h"
+
+#include "common/utils/Misc.h"
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+const char *usage =
+    "Usage: ./examtop [-i refresh interval ms] [-n refresh count]";
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  int intervalMs = 1000;
+  int refreshCount = 0;
+
+  try {
+    int option;
+    while ((option = getopt(argc, argv, "i:n:")) != -1) {
+      switch (option) {
+      case 'i':
+        intervalMs = std::stoi(optarg);
+        break;
+      case 'n':
+        refreshCount = std::stoi(optarg);
+        break;
+      default:
+        throw std::invalid_argument(usage);
+      }
+    }
+
+    if (optind != argc) {
+      throw std::invalid_argument(usage);
+    }
+
+    /* Expected value: n > 0 */
+    if (intervalMs <= 0) {
+      throw std::invalid_argument("Invalid refresh interval. Expected: 0 < n");
+    }
+
+    /* Expected value: n >= 0 (0 - until the exam finishes) */
+    if (refreshCount < 0) {
+      throw std::invalid_argument("Invalid refresh count. Expected: 0 <= n");
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "Failed to validate arguments: \n\t" << e.what() << std::endl;
+    return 1;
+  }
+
+  try {
+    ExamMonitor monitor;
+    bool terminal = isatty(STDOUT_FILENO);
+
+    for (int i = 0; refreshCount == 0 || i < refreshCount; i++) {
+      bool finished = monitor.finished();
+
+      /* Redraw in place on a terminal, append otherwise */
+      if (terminal) {
+        std::cout << "\033[H\033[2J";
+      }
+      std::cout << monitor.snapshot() << std::endl;
+
+      if (finished) {
+        break;
+      }
+
+      Misc::safeUSleep(intervalMs * 1000);
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "Failed to monitor the exam: " << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}